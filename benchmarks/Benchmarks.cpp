@@ -0,0 +1,360 @@
+/*
+    Headless DSP benchmark.
+
+    Sweeps the DPCM core over every sample rate index, system, engine, anti-aliasing setting, host rate,
+    block size and channel count, and the speaker, clipper and full processor over host rate, block size
+    and channel count, in both precisions. The processor also runs the way a 64-bit host drives a
+    float-only plugin (precision double_converted) for comparison. Results are written as CSV (one row
+    per configuration) so runs from different releases can be diffed or plotted.
+
+    Usage: Benchmarks [--quick] [--offline] [--seconds <s>] [--output <file.csv>]
+           Benchmarks --verify [--write-golden <dir>] [--golden <dir>]
+
+    --verify checks the DSP core against the frozen reference instead of timing it, see Verification.h.
+    cmake/VerifyFastMath.cmake (or the VerifyFastMath target) runs it on a Release build against a Debug one.
+*/
+
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <BinaryData.h>
+#include <IA_Waveshaping/BasicClippers.hpp>
+#include "DSP/DeltaModulation.h"
+#include "DSP/SpeakerBank.h"
+#include "DSP/SoftClipper.h"
+#include "PluginProcessor.h"
+#include "Verification.h"
+
+namespace
+{
+    struct Options
+    {
+        bool quick = false;
+        bool offline = false;
+        double seconds = 0.25;
+    };
+
+    struct Matrix
+    {
+        std::vector<int> srIndices;
+        std::vector<double> hostRates;
+        std::vector<int> blockSizes;
+        std::vector<int> channelCounts;
+    };
+
+    Matrix getMatrix (const Options& options)
+    {
+        if(options.quick) {
+            return { { 0, 7, 15 }, { 44100.0, 96000.0, 192000.0 }, { 64, 512 }, { 1, 2, 8, 16 } };
+        }
+
+        std::vector<int> allIndices(16);
+        std::iota(allIndices.begin(), allIndices.end(), 0);
+        return { allIndices, { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 }, { 16, 32, 64, 128, 256, 512, 1024 }, { 1, 2, 4, 6, 8, 16 } };
+    }
+
+    //==============================================================================
+    /** One CSV row. Columns that don't apply to a stage are left empty. */
+    struct Result
+    {
+        juce::String stage, precision, engine, system;
+        int srIndex = -1, antiAliasing = -1;
+        double hostRate = 0.0;
+        int blockSize = 0, channels = 0;
+        double nsPerSample = 0.0;
+    };
+
+    juce::String getHeader()
+    {
+        return "version,stage,precision,engine,system,sr_index,anti_aliasing,host_rate,block_size,channels,ns_per_sample,ns_per_channel_sample";
+    }
+
+    juce::String toCSV (const Result& r)
+    {
+        auto optional = [] (int value) { return value < 0 ? juce::String() : juce::String(value); };
+
+        juce::StringArray row;
+        row.add(VERSION);
+        row.add(r.stage);
+        row.add(r.precision);
+        row.add(r.engine);
+        row.add(r.system);
+        row.add(optional(r.srIndex));
+        row.add(optional(r.antiAliasing));
+        row.add(juce::String(r.hostRate, 0));
+        row.add(juce::String(r.blockSize));
+        row.add(juce::String(r.channels));
+        row.add(juce::String(r.nsPerSample, 3));
+        row.add(juce::String(r.nsPerSample / r.channels, 3));
+        return row.joinIntoString(",");
+    }
+
+    //==============================================================================
+    /** Runs process() over the given number of seconds of noise and returns the average ns per sample frame.
+        The input is refreshed before every block, outside the timed region.
+    */
+    template <typename SampleType, typename ProcessFunction>
+    double timeBlocks (double hostRate, int blockSize, int numChannels, double seconds, ProcessFunction&& process)
+    {
+        juce::AudioBuffer<SampleType> source(numChannels, blockSize), work(numChannels, blockSize);
+
+        juce::Random random(0x5107e);
+        for(int c = 0; c < numChannels; ++c) {
+            for(int s = 0; s < blockSize; ++s) {
+                source.setSample(c, s, static_cast<SampleType>(0.25 * (random.nextDouble() * 2.0 - 1.0)));
+            }
+        }
+
+        const auto numBlocks = juce::jmax(4, static_cast<int>(seconds * hostRate / blockSize));
+        const auto numWarmupBlocks = numBlocks / 4;
+
+        juce::ScopedNoDenormals noDenormals;
+        std::chrono::nanoseconds total { 0 };
+
+        for(int b = 0; b < numWarmupBlocks + numBlocks; ++b)
+        {
+            work.makeCopyOf(source, true);
+
+            const auto start = std::chrono::steady_clock::now();
+            process(work);
+            const auto end = std::chrono::steady_clock::now();
+
+            if(b >= numWarmupBlocks) {
+                total += end - start;
+            }
+        }
+
+        return static_cast<double>(total.count()) / (static_cast<double>(numBlocks) * blockSize);
+    }
+
+    template <typename SampleType>
+    juce::String getPrecisionName()
+    {
+        return std::is_same_v<SampleType, float> ? "float" : "double";
+    }
+
+    //==============================================================================
+    template <typename SampleType>
+    void benchmarkDeltaModulation (const Options& options, const Matrix& matrix, std::function<void (const Result&)> report)
+    {
+        using DPCM = DeltaModulation<SampleType>;
+
+        for(auto engine : { DPCM::Engine::Oversampled, DPCM::Engine::TickSampled })
+        for(auto system : { DPCM::System::PAL, DPCM::System::NTSC })
+        for(auto srIndex : matrix.srIndices)
+        for(auto antiAliasing : { true, false })
+        for(auto hostRate : matrix.hostRates)
+        for(auto blockSize : matrix.blockSizes)
+        for(auto numChannels : matrix.channelCounts)
+        {
+            DPCM dpcm;
+            dpcm.setEngine(engine);
+            dpcm.setQuality(options.offline ? DPCM::Quality::Offline : DPCM::Quality::Realtime);
+            dpcm.prepare({ hostRate, juce::uint32(blockSize), juce::uint32(numChannels) });
+            dpcm.setSystem(system);
+            dpcm.setSampleRate(srIndex);
+            dpcm.setAntiAliasing(antiAliasing);
+
+            Result r;
+            r.stage = "dpcm";
+            r.precision = getPrecisionName<SampleType>();
+            r.engine = engine == DPCM::Engine::Oversampled ? "oversampled" : "tick";
+            r.system = system == DPCM::System::PAL ? "pal" : "ntsc";
+            r.srIndex = srIndex;
+            r.antiAliasing = antiAliasing ? 1 : 0;
+            r.hostRate = hostRate;
+            r.blockSize = blockSize;
+            r.channels = numChannels;
+            r.nsPerSample = timeBlocks<SampleType>(hostRate, blockSize, numChannels, options.seconds, [&] (auto& buffer)
+            {
+                auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+                dpcm.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+            });
+
+            report(r);
+        }
+    }
+
+    template <typename SampleType>
+    void benchmarkClippers (const Options& options, const Matrix& matrix, std::function<void (const Result&)> report)
+    {
+        for(auto hostRate : matrix.hostRates)
+        for(auto blockSize : matrix.blockSizes)
+        for(auto numChannels : matrix.channelCounts)
+        {
+            Result r;
+            r.precision = getPrecisionName<SampleType>();
+            r.hostRate = hostRate;
+            r.blockSize = blockSize;
+            r.channels = numChannels;
+
+            // the per-sample loop the speaker stage used before the ADAA clipper
+            r.stage = "clipper_scalar";
+            r.nsPerSample = timeBlocks<SampleType>(hostRate, blockSize, numChannels, options.seconds, [&] (auto& buffer)
+            {
+                for(int c = 0; c < buffer.getNumChannels(); ++c)
+                {
+                    auto* data = buffer.getWritePointer(c);
+                    for(int s = 0; s < buffer.getNumSamples(); ++s) {
+                        data[s] = IADSP::BasicClippers::cubicSoftClip(data[s]);
+                    }
+                }
+            });
+            report(r);
+
+            SoftClipper<SampleType> clipper;
+            clipper.prepare({ hostRate, juce::uint32(blockSize), juce::uint32(numChannels) });
+
+            r.stage = "clipper_adaa";
+            r.nsPerSample = timeBlocks<SampleType>(hostRate, blockSize, numChannels, options.seconds, [&] (auto& buffer)
+            {
+                auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+                clipper.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+            });
+            report(r);
+        }
+    }
+
+    template <typename SampleType>
+    void benchmarkSpeakers (const Options& options, const Matrix& matrix, std::function<void (const Result&)> report)
+    {
+        for(auto hostRate : matrix.hostRates)
+        for(auto blockSize : matrix.blockSizes)
+        for(auto numChannels : matrix.channelCounts)
+        {
+            SpeakerBank<SampleType> speaker;
+            speaker.addImpulseResponse(BinaryData::HS200_SM58_Close_wav, size_t(BinaryData::HS200_SM58_Close_wavSize));
+            speaker.addImpulseResponse(BinaryData::VL1_SM58_Edge_wav, size_t(BinaryData::VL1_SM58_Edge_wavSize));
+            speaker.prepare({ hostRate, juce::uint32(blockSize), juce::uint32(numChannels) });
+
+            for(int index = 1; index < speaker.getNumSpeakers(); ++index)
+            {
+                speaker.setSpeaker(index);
+                speaker.reset();
+
+                Result r;
+                r.stage = "speaker_" + juce::String(index);
+                r.precision = getPrecisionName<SampleType>();
+                r.hostRate = hostRate;
+                r.blockSize = blockSize;
+                r.channels = numChannels;
+                r.nsPerSample = timeBlocks<SampleType>(hostRate, blockSize, numChannels, options.seconds, [&] (auto& buffer)
+                {
+                    auto block = juce::dsp::AudioBlock<SampleType>(buffer);
+                    speaker.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+                });
+                report(r);
+            }
+        }
+    }
+
+    /** The whole plugin, default parameters, for channel scaling. Runs at the given precision, or with
+        convertDoubles at single precision behind a double to float conversion, the way a 64-bit host
+        drives a plugin that only has the float processBlock.
+    */
+    template <typename SampleType>
+    void benchmarkProcessor (const Options& options, const Matrix& matrix, std::function<void (const Result&)> report, bool convertDoubles = false)
+    {
+        constexpr auto isDouble = std::is_same_v<SampleType, double>;
+
+        for(auto hostRate : matrix.hostRates)
+        for(auto blockSize : matrix.blockSizes)
+        for(auto numChannels : matrix.channelCounts)
+        {
+            AudioPluginAudioProcessor processor;
+            processor.setPlayConfigDetails(numChannels, numChannels, hostRate, blockSize);
+            processor.setProcessingPrecision(isDouble && !convertDoubles ? juce::AudioProcessor::doublePrecision
+                                                                         : juce::AudioProcessor::singlePrecision);
+            processor.setNonRealtime(options.offline);
+            processor.prepareToPlay(hostRate, blockSize);
+
+            juce::MidiBuffer midi;
+            juce::AudioBuffer<float> floatBuffer(numChannels, blockSize);
+
+            Result r;
+            r.stage = "processor";
+            r.precision = convertDoubles ? "double_converted" : getPrecisionName<SampleType>();
+            r.hostRate = hostRate;
+            r.blockSize = blockSize;
+            r.channels = numChannels;
+            r.nsPerSample = timeBlocks<SampleType>(hostRate, blockSize, numChannels, options.seconds, [&] (auto& buffer)
+            {
+                if constexpr (isDouble)
+                {
+                    if(convertDoubles)
+                    {
+                        floatBuffer.makeCopyOf(buffer, true);
+                        processor.processBlock(floatBuffer, midi);
+                        buffer.makeCopyOf(floatBuffer, true);
+                        return;
+                    }
+                }
+                processor.processBlock(buffer, midi);
+            });
+            report(r);
+
+            processor.releaseResources();
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args(argc, argv);
+
+    if(args.containsOption("--verify")) {
+        return runVerification(args);
+    }
+
+    Options options;
+    options.quick = args.containsOption("--quick");
+    options.offline = args.containsOption("--offline");
+    if(args.containsOption("--seconds")) {
+        options.seconds = juce::jmax(0.01, args.getValueForOption("--seconds").getDoubleValue());
+    }
+
+    std::unique_ptr<juce::FileOutputStream> file;
+    if(args.containsOption("--output"))
+    {
+        const auto outputFile = args.getFileForOption("--output");
+        outputFile.deleteFile();
+        file = std::make_unique<juce::FileOutputStream>(outputFile);
+
+        if(!file->openedOk()) {
+            std::cerr << "Could not open " << outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    auto writeLine = [&] (const juce::String& line)
+    {
+        if(file != nullptr) {
+            *file << line << "\n";
+            file->flush();
+        }
+        else {
+            std::cout << line << std::endl;
+        }
+    };
+
+    auto report = [&] (const Result& r) { writeLine(toCSV(r)); };
+
+    const auto matrix = getMatrix(options);
+
+    writeLine(getHeader());
+    benchmarkDeltaModulation<float>(options, matrix, report);
+    benchmarkDeltaModulation<double>(options, matrix, report);
+    benchmarkClippers<float>(options, matrix, report);
+    benchmarkClippers<double>(options, matrix, report);
+    benchmarkSpeakers<float>(options, matrix, report);
+    benchmarkSpeakers<double>(options, matrix, report);
+    benchmarkProcessor<float>(options, matrix, report);
+    benchmarkProcessor<double>(options, matrix, report);
+    benchmarkProcessor<double>(options, matrix, report, true);
+
+    return 0;
+}
@@ -0,0 +1,406 @@
+#pragma once
+
+/*
+    Frozen copy of DeltaModulation as it was before the optimisation work (scalar, one channel at a time,
+    juce::dsp::BallisticsFilter envelopes, std::pow gate, per-filter passes). Do not change it: the
+    verification mode of the Benchmarks target treats its output as the ground truth.
+
+    The only addition is processQuantiser(), which matches the hook on DeltaModulation.
+*/
+#include <juce_dsp/juce_dsp.h>
+#include <numbers>
+#include <IA_Filters/EQ/OnePoleEQFilter.hpp>
+
+template <typename SampleType>
+class ReferenceDeltaModulation
+{
+public:
+    enum struct System
+    {
+        PAL,
+        NTSC
+    };
+
+    ReferenceDeltaModulation();
+
+    //==============================================================================
+    /** Sets the Sample Rate index (values 0-15 accepted)*/
+    void setSampleRate (int sampleRateIndex);
+    
+    /** Sets the system to use (PAL or NTSC)*/
+    void setSystem (System systemToUse);
+
+    /** Sets whether filtering should be applied before and after re-sampling to reduce aliasing*/
+    void setAntiAliasing (bool shouldUseAntiAliasing);
+
+    //==============================================================================
+    /** Returns the number of available sample rates to be used with setSampleRate()*/
+    int getNumSampleRates() const { return static_cast<int>(srLookupPAL.size()); }
+
+    /** Returns the latency produced by the module. Call this after prepare(). Latency may be 0 at higher sample rates.*/
+    int getLatencyInSamples() const { return juce::roundToInt(overSampler.getLatencyInSamples()); }
+
+    //==============================================================================
+    /** Initialises the processor. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /** Resets the internal state variables of the processor. */
+    void reset();
+
+    //==============================================================================
+    /** Processes the input and output samples supplied in the processing context. */
+    template <typename ProcessContext>
+    void process (const ProcessContext& context) noexcept
+    {
+        const auto& inputBlock = context.getInputBlock();
+        auto& outputBlock      = context.getOutputBlock();
+        const auto numChannels = outputBlock.getNumChannels();
+
+        jassert (inputBlock.getNumChannels() == numChannels);
+        jassert (inputBlock.getNumSamples() == outputBlock.getNumSamples());
+
+        outputBlock.copyFrom(inputBlock);
+        if (context.isBypassed) {
+            return;
+        }
+
+        if(antiAliasing)
+        {
+            for(auto& f : aaFilters) {
+                f.process(context);
+            }
+        }
+
+        auto numSamples = outputBlock.getNumSamples();
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* outputSamples = outputBlock.getChannelPointer (channel);
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                outputSamples[i] = dcPreFilter.processSample ((int) channel, outputSamples[i]);
+                outputSamples[i] += highBoost.processSample(outputSamples[i], (int) channel);
+            }
+        }
+
+        auto osBlock = overSampler.processSamplesUp(outputBlock);
+        numSamples = osBlock.getNumSamples();
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* outputSamples = osBlock.getChannelPointer (channel);
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                outputSamples[i] = processSample ((int) channel, outputSamples[i]);
+            }
+        }
+
+        overSampler.processSamplesDown(outputBlock);
+
+        numSamples = outputBlock.getNumSamples();
+        if(antiAliasing)
+        {
+            for (size_t channel = 0; channel < numChannels; ++channel)
+            {
+                auto* outputSamples = outputBlock.getChannelPointer (channel);
+
+                for (size_t i = 0; i < numSamples; ++i) {
+                    outputSamples[i] = postFilter.processSample ((int) channel, outputSamples[i]);
+                }
+            }
+        }
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            auto* outputSamples = outputBlock.getChannelPointer (channel);
+
+            for (size_t i = 0; i < numSamples; ++i) {
+                outputSamples[i] = dcPostFilter.processSample ((int) channel, outputSamples[i]);
+            }
+        }
+
+        if(antiAliasing) {
+            for(auto& f : aaFilters) {
+                f.snapToZero();
+            }
+            postFilter.snapToZero();
+        }
+        dcPreFilter.snapToZero();
+        dcPostFilter.snapToZero();
+    }
+
+    /** Runs only processSample() over the block, in place, with no filtering or resampling. */
+    void processQuantiser (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        for (size_t channel = 0; channel < block.getNumChannels(); ++channel)
+        {
+            auto* samples = block.getChannelPointer (channel);
+
+            for (size_t i = 0; i < block.getNumSamples(); ++i) {
+                samples[i] = processSample ((int) channel, samples[i]);
+            }
+        }
+    }
+
+private:
+
+    void update();
+
+    SampleType processSample (int channel, SampleType inputValue);
+
+    static constexpr double targetSampleRate = 133000.0;
+    static constexpr int numBits             = 7;
+    static constexpr SampleType bitDepth     = static_cast<SampleType>((1 << numBits) - 1);
+    static constexpr SampleType bitFactor    = bitDepth * static_cast<SampleType>(0.5);
+
+    static constexpr std::array<double, 16> srLookupPAL
+    {
+        4177.4,
+        4696.63,
+        5261.41,
+        5579.22,
+        6023.94,
+        7044.94,
+        7917.18,
+        8397.01,
+        9446.63,
+        11233.8,
+        12595.5,
+        14089.9,
+        16965.4,
+        21315.5,
+        25191.0,
+        33252.1
+    };
+
+    static constexpr std::array<double, 16> srLookupNTSC
+    {
+        4181.71,
+        4709.93,
+        5264.04,
+        5593.04,
+        6257.95,
+        7046.35,
+        7919.35,
+        8363.42,
+        9419.86,
+        11186.1,
+        12604.0,
+        13982.6,
+        16884.6,
+        21306.8,
+        24858.0,
+        33143.9
+    };
+
+    bool antiAliasing = true;
+    int srIndex = 15;
+    System system = System::PAL;
+    double externalSampleRate = 48000.0, internalSampleRate = 33252.1;
+    double clockInc = 1.0;
+
+    int channels = 1;
+    static constexpr int numFilters = 4;
+
+    static constexpr SampleType threshold = static_cast<SampleType>(1.0) / bitFactor;
+    static constexpr SampleType gateRatio = static_cast<SampleType>(50.0);
+
+    IADSP::OnePoleEQFilter<SampleType> highBoost { IADSP::OnePoleEQFilterMode::HighPass };
+    std::vector<juce::dsp::StateVariableTPTFilter<SampleType>> aaFilters;
+    juce::dsp::StateVariableTPTFilter<SampleType> postFilter;
+    juce::dsp::Oversampling<SampleType> overSampler;
+    juce::dsp::BallisticsFilter<SampleType> envelopeFilter, RMSFilter;
+    juce::dsp::FirstOrderTPTFilter<SampleType> dcPreFilter, dcPostFilter;
+
+    std::vector<SampleType> z1;
+    std::vector<SampleType> output;
+    std::vector<double> clockPhase;
+
+};
+
+//==============================================================================
+template <typename SampleType>
+ReferenceDeltaModulation<SampleType>::ReferenceDeltaModulation()
+{
+    RMSFilter.setLevelCalculationType (juce::dsp::BallisticsFilterLevelCalculationType::RMS);
+    RMSFilter.setAttackTime(static_cast<SampleType>(0.0));
+    RMSFilter.setReleaseTime(static_cast<SampleType>(50.0));
+    
+    envelopeFilter.setAttackTime(static_cast<SampleType>(0.0));
+    envelopeFilter.setReleaseTime(static_cast<SampleType>(10.0));
+
+    dcPreFilter.setType(juce::dsp::FirstOrderTPTFilterType::highpass);
+    dcPostFilter.setType(juce::dsp::FirstOrderTPTFilterType::highpass);
+
+    dcPreFilter.setCutoffFrequency(static_cast<SampleType>(20.0));
+    dcPostFilter.setCutoffFrequency(static_cast<SampleType>(20.0));
+
+    highBoost.setFrequency(static_cast<SampleType>(1000.0));
+    highBoost.setGainDB(static_cast<SampleType>(6.0));
+
+}
+
+template <typename SampleType>
+void ReferenceDeltaModulation<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    channels = spec.numChannels;
+
+    z1.resize(channels);
+    output.resize(channels);
+    clockPhase.resize(channels);
+
+    highBoost.setSampleRate(spec.sampleRate);
+    highBoost.setNumChannels(channels);
+
+    aaFilters.clear();
+    aaFilters.resize(numFilters);
+
+    for(auto& f : aaFilters) {
+        f.prepare(spec);
+        f.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+        f.setResonance(static_cast<SampleType>(1.0) / std::numbers::sqrt2_v<SampleType>);
+    }
+
+    postFilter.prepare(spec);
+    postFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+    postFilter.setResonance(static_cast<SampleType>(1.0) / std::numbers::sqrt2_v<SampleType>);
+
+    dcPreFilter.prepare(spec);
+    dcPostFilter.prepare(spec);
+
+    overSampler.numChannels = channels;
+    overSampler.setUsingIntegerLatency(true);
+    overSampler.clearOversamplingStages();
+
+    externalSampleRate = spec.sampleRate;
+    if(externalSampleRate >= targetSampleRate)
+    {
+        overSampler.addDummyOversamplingStage();
+    }
+    else
+    {
+        int n = 0;
+        while(externalSampleRate < targetSampleRate)
+        {
+            externalSampleRate *= 2.0;
+            if(n == 0) {
+                overSampler.addOversamplingStage(juce::dsp::Oversampling<SampleType>::FilterType::filterHalfBandFIREquiripple, 0.05f, -90.0f, 0.06f, -75.0f);
+            }
+            else {
+                overSampler.addOversamplingStage(juce::dsp::Oversampling<SampleType>::FilterType::filterHalfBandPolyphaseIIR, 0.1f, -70.0f, 0.12f, -60.0f);
+            }
+            ++n;
+        }
+    }
+    overSampler.initProcessing(spec.maximumBlockSize);
+    auto osSpec = spec;
+    osSpec.sampleRate = externalSampleRate;
+    RMSFilter.prepare(osSpec);
+    envelopeFilter.prepare(osSpec);
+
+    update();
+    reset();
+}
+
+template <typename SampleType>
+void ReferenceDeltaModulation<SampleType>::reset()
+{
+    std::fill(z1.begin(), z1.end(), static_cast<SampleType>(63.0));
+    std::fill(output.begin(), output.end(), static_cast<SampleType>(0.0));
+    std::fill(clockPhase.begin(), clockPhase.end(), 1.0);
+
+    for(auto& f : aaFilters) {
+        f.reset();
+    }
+    postFilter.reset();
+
+    RMSFilter.reset();
+    envelopeFilter.reset();
+    dcPreFilter.reset();
+    dcPostFilter.reset();
+    highBoost.reset();
+}
+
+template <typename SampleType>
+void ReferenceDeltaModulation<SampleType>::update()
+{
+    clockInc = internalSampleRate / externalSampleRate;
+    for(auto& f : aaFilters) {
+        f.setCutoffFrequency(static_cast<SampleType>(internalSampleRate * 0.5));
+    }
+    postFilter.setCutoffFrequency(static_cast<SampleType>(internalSampleRate * 0.5));
+}
+
+template <typename SampleType>
+SampleType ReferenceDeltaModulation<SampleType>::processSample (int channel, SampleType inputValue)
+{
+    jassert(channel < channels);
+
+    auto env = RMSFilter.processSample (channel, inputValue);
+    env = envelopeFilter.processSample (channel, env);
+
+    if(clockPhase[channel] >= 1.0)
+    {
+        clockPhase[channel] -= 1.0;
+
+        auto x = inputValue * bitFactor;
+        x += bitFactor;
+        x = juce::jlimit(static_cast<SampleType>(0.0), bitDepth, x);
+
+        x = std::round(x) > z1[channel] ? static_cast<SampleType>(1.0) : static_cast<SampleType>(-1.0);
+        x += z1[channel];
+
+        z1[channel] = x;
+        x = x / bitFactor;
+        x -= static_cast<SampleType>(1.0);
+        output[channel] = x;
+    }
+    clockPhase[channel] += clockInc;
+
+    auto gain = (env > threshold) ? static_cast<SampleType> (1.0)
+                                  : std::pow (env * bitFactor, gateRatio);
+
+    return output[channel] * gain;
+}
+
+template <typename SampleType>
+void ReferenceDeltaModulation<SampleType>::setSampleRate (int sampleRateIndex)
+{
+    jassert(juce::isPositiveAndNotGreaterThan(sampleRateIndex, 16));
+    srIndex = juce::jlimit(0, 15, sampleRateIndex);
+
+    if(system == System::PAL) {
+        internalSampleRate = srLookupPAL[srIndex];
+    }
+    else {
+        internalSampleRate = srLookupNTSC[srIndex];
+    }
+
+    update();
+}
+    
+template <typename SampleType>
+void ReferenceDeltaModulation<SampleType>::setSystem (System systemToUse)
+{
+    if(systemToUse != system)
+    {
+        system = systemToUse;
+        setSampleRate(srIndex);
+    }
+}
+
+template <typename SampleType>
+void ReferenceDeltaModulation<SampleType>::setAntiAliasing (bool shouldUseAntiAliasing)
+{
+    if(antiAliasing != shouldUseAntiAliasing)
+    {
+        antiAliasing = shouldUseAntiAliasing;
+        
+        for(auto& f : aaFilters) {
+            f.reset();
+        }
+        postFilter.reset();
+    }
+}
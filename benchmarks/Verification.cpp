@@ -0,0 +1,722 @@
+#include "Verification.h"
+#include <iostream>
+#include <optional>
+#include "ReferenceDeltaModulation.h"
+#include "DSP/DeltaModulation.h"
+
+namespace
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 97; // odd on purpose, so ticks and SIMD groups land at every offset in a block
+    constexpr double renderSeconds = 0.25;
+
+    enum struct Check
+    {
+        Counter,
+        Quantiser,
+        Chain
+    };
+
+    const char* getCheckName (Check check)
+    {
+        switch(check)
+        {
+            case Check::Counter:   return "counter";
+            case Check::Quantiser: return "quantiser";
+            case Check::Chain:     return "chain";
+        }
+        return "";
+    }
+
+    //==============================================================================
+    /** Deterministic test signals. The gate-open ones sit on a DC offset so the RMS never falls below the threshold,
+        and are single sines, so the spectral check can fit them (frequency and frequencyPerChannel give the sine in Hz).
+    */
+    struct TestSignal
+    {
+        const char* name;
+        bool keepsGateOpen;
+        double (*generate) (int channel, double time);
+        double frequency = 0.0, frequencyPerChannel = 0.0;
+
+        double getFrequency (int channel) const { return frequency + frequencyPerChannel * channel; }
+    };
+
+    const std::array<TestSignal, 5> testSignals
+    {{
+        { "dc_sine",      true,  [] (int channel, double t) { return 0.5 + 0.3 * std::sin(juce::MathConstants<double>::twoPi * (997.0 + 113.0 * channel) * t); }, 997.0, 113.0 },
+        { "neg_dc_sine",  true,  [] (int channel, double t) { return -0.4 - 0.05 * channel + 0.35 * std::sin(juce::MathConstants<double>::twoPi * 1499.0 * t); }, 1499.0 },
+        { "decay",        false, [] (int channel, double t) { return 0.8 * std::exp(-20.0 * t) * std::sin(juce::MathConstants<double>::twoPi * (220.0 + 55.0 * channel) * t); } },
+        { "sweep",        false, [] (int channel, double t) { return 0.5 * std::sin(juce::MathConstants<double>::twoPi * 20.0 * (std::pow(1000.0, t / renderSeconds) - 1.0) * renderSeconds / std::log(1000.0) + channel); } },
+        { "noise_bursts", false, [] (int channel, double t)
+            {
+                // cheap hash noise, identical on every platform
+                auto n = static_cast<juce::uint32>(t * 1.0e7) * 2654435761u + static_cast<juce::uint32>(channel) * 40503u;
+                n ^= n >> 15;
+                const auto noise = static_cast<double>(n & 0xffff) / 32768.0 - 1.0;
+                return std::fmod(t, 0.05) < 0.025 ? 0.3 * noise : 0.0;
+            } },
+    }};
+
+    //==============================================================================
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType> makeInput (const TestSignal& signal, double sampleRate)
+    {
+        const auto numSamples = static_cast<int>(renderSeconds * sampleRate);
+        juce::AudioBuffer<SampleType> buffer(numChannels, numSamples);
+
+        for(int c = 0; c < numChannels; ++c) {
+            for(int s = 0; s < numSamples; ++s) {
+                buffer.setSample(c, s, static_cast<SampleType>(signal.generate(c, s / sampleRate)));
+            }
+        }
+        return buffer;
+    }
+
+    /** Renders in place, block by block, through either process() or processQuantiser(). */
+    template <typename SampleType, typename Processor>
+    void render (Processor& processor, juce::AudioBuffer<SampleType>& buffer, bool quantiserOnly, int blockLength = blockSize)
+    {
+        auto whole = juce::dsp::AudioBlock<SampleType>(buffer);
+        const auto length = static_cast<size_t>(blockLength);
+
+        for(size_t start = 0; start < whole.getNumSamples(); start += length)
+        {
+            auto block = whole.getSubBlock(start, juce::jmin(length, whole.getNumSamples() - start));
+
+            if(quantiserOnly) {
+                processor.processQuantiser(block);
+            }
+            else {
+                processor.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+            }
+        }
+    }
+
+    template <typename Processor>
+    void configure (Processor& processor, bool pal, int srIndex, bool antiAliasing)
+    {
+        processor.setSystem(pal ? Processor::System::PAL : Processor::System::NTSC);
+        processor.setSampleRate(srIndex);
+        processor.setAntiAliasing(antiAliasing);
+    }
+
+    //==============================================================================
+    struct Comparison
+    {
+        double maxError = 0.0, rmsError = 0.0;
+        int numMismatches = 0, numSamples = 0;
+    };
+
+    template <typename SampleType>
+    Comparison compare (const juce::AudioBuffer<SampleType>& expected, const juce::AudioBuffer<SampleType>& actual, double tolerance)
+    {
+        Comparison result;
+        double sumSquares = 0.0;
+
+        for(int c = 0; c < expected.getNumChannels(); ++c)
+        {
+            for(int s = 0; s < expected.getNumSamples(); ++s)
+            {
+                const auto error = std::abs(static_cast<double>(expected.getSample(c, s)) - static_cast<double>(actual.getSample(c, s)));
+
+                result.maxError = juce::jmax(result.maxError, error);
+                sumSquares += error * error;
+                result.numMismatches += error > tolerance ? 1 : 0;
+                ++result.numSamples;
+            }
+        }
+
+        result.rmsError = std::sqrt(sumSquares / juce::jmax(1, result.numSamples));
+        return result;
+    }
+
+    //==============================================================================
+    /** Golden renders are stored as raw little-endian doubles, channel after channel. */
+    template <typename SampleType>
+    bool writeGolden (const juce::File& file, const juce::AudioBuffer<SampleType>& buffer)
+    {
+        file.deleteFile();
+        juce::FileOutputStream stream(file);
+
+        if(!stream.openedOk()) {
+            return false;
+        }
+
+        for(int c = 0; c < buffer.getNumChannels(); ++c) {
+            for(int s = 0; s < buffer.getNumSamples(); ++s) {
+                stream.writeDouble(static_cast<double>(buffer.getSample(c, s)));
+            }
+        }
+        return true;
+    }
+
+    template <typename SampleType>
+    bool readGolden (const juce::File& file, juce::AudioBuffer<SampleType>& buffer)
+    {
+        juce::FileInputStream stream(file);
+
+        if(!stream.openedOk() || stream.getTotalLength() != static_cast<juce::int64>(sizeof(double)) * buffer.getNumChannels() * buffer.getNumSamples()) {
+            return false;
+        }
+
+        for(int c = 0; c < buffer.getNumChannels(); ++c) {
+            for(int s = 0; s < buffer.getNumSamples(); ++s) {
+                buffer.setSample(c, s, static_cast<SampleType>(stream.readDouble()));
+            }
+        }
+        return true;
+    }
+
+    //==============================================================================
+    struct Settings
+    {
+        juce::File writeGoldenDirectory, readGoldenDirectory;
+        int numFailures = 0;
+    };
+
+    void printRow (const juce::StringArray& row)
+    {
+        std::cout << row.joinIntoString(",") << std::endl;
+    }
+
+    /** Writes expected as the golden render for the case, and/or compares actual against the golden render
+        another build wrote, depending on the settings.
+    */
+    template <typename SampleType>
+    void runGoldenCheck (Settings& settings, const juce::StringArray& caseName, const juce::AudioBuffer<SampleType>& expected,
+                         const juce::AudioBuffer<SampleType>& actual)
+    {
+        const auto goldenName = caseName.joinIntoString("_") + ".f64";
+
+        if(settings.writeGoldenDirectory != juce::File())
+        {
+            if(!writeGolden(settings.writeGoldenDirectory.getChildFile(goldenName), expected)) {
+                std::cerr << "Could not write " << goldenName << std::endl;
+                ++settings.numFailures;
+            }
+        }
+
+        if(settings.readGoldenDirectory != juce::File())
+        {
+            auto golden = expected;
+            if(!readGolden(settings.readGoldenDirectory.getChildFile(goldenName), golden)) {
+                std::cerr << "Missing or mismatched golden render " << goldenName << std::endl;
+                ++settings.numFailures;
+                return;
+            }
+
+            const auto goldenResult = compare(golden, actual, goldenSampleTolerance);
+            const auto goldenPassed = goldenResult.numMismatches <= goldenMaxMismatchRatio * goldenResult.numSamples
+                                   && goldenResult.rmsError <= goldenMaxRMSError;
+            settings.numFailures += goldenPassed ? 0 : 1;
+
+            auto goldenRow = caseName;
+            goldenRow.add("golden");
+            goldenRow.add(juce::String(goldenResult.rmsError, 17));
+            goldenRow.add(juce::String(goldenResult.numMismatches));
+            goldenRow.add(goldenPassed ? "pass" : "FAIL");
+            printRow(goldenRow);
+        }
+    }
+
+    template <typename SampleType>
+    void runCase (Settings& settings, Check check, const TestSignal& signal, double sampleRate, bool pal, int srIndex, bool antiAliasing)
+    {
+        const auto quantiserOnly = check != Check::Chain;
+        const auto tolerance = check == Check::Counter ? counterTolerance<SampleType> : quantiserTolerance<SampleType>;
+        const juce::uint32 maxBlockSize = blockSize;
+
+        ReferenceDeltaModulation<SampleType> reference;
+        reference.prepare({ sampleRate, maxBlockSize, numChannels });
+        configure(reference, pal, srIndex, antiAliasing);
+
+        DeltaModulation<SampleType> optimised;
+        optimised.prepare({ sampleRate, maxBlockSize, numChannels });
+        configure(optimised, pal, srIndex, antiAliasing);
+
+        auto expected = makeInput<SampleType>(signal, sampleRate);
+        auto actual = expected;
+
+        render(reference, expected, quantiserOnly);
+        render(optimised, actual, quantiserOnly);
+
+        juce::StringArray caseName;
+        caseName.add(getCheckName(check));
+        caseName.add(std::is_same_v<SampleType, float> ? "float" : "double");
+        caseName.add(signal.name);
+        caseName.add(pal ? "pal" : "ntsc");
+        caseName.add(juce::String(srIndex));
+        caseName.add(juce::String(antiAliasing ? 1 : 0));
+        caseName.add(juce::String(sampleRate, 0));
+
+        const auto result = compare(expected, actual, tolerance);
+        const auto passed = result.numMismatches == 0;
+        settings.numFailures += passed ? 0 : 1;
+
+        auto row = caseName;
+        row.add("reference");
+        row.add(juce::String(result.maxError, 17));
+        row.add(juce::String(result.numMismatches));
+        row.add(passed ? "pass" : "FAIL");
+        printRow(row);
+
+        runGoldenCheck(settings, caseName, expected, actual);
+    }
+
+    /** The gate curve's square-and-multiply chain against std::pow, within the bound GateCurve documents. */
+    template <typename SampleType>
+    void runGateCurveCheck (Settings& settings)
+    {
+        using Gate = typename DeltaModulation<SampleType>::Gate;
+
+        const auto passed = Gate::template isWithinErrorBound<SampleType>(gateCurveSweepPoints);
+        settings.numFailures += passed ? 0 : 1;
+
+        printRow({ "gate_curve", std::is_same_v<SampleType, float> ? "float" : "double", "sweep", "", "", "", "",
+                   "std_pow", juce::String(static_cast<double>(Gate::template maxRelativeError<SampleType>()), 17),
+                   passed ? "0" : "1", passed ? "pass" : "FAIL" });
+    }
+
+    //==============================================================================
+    /** One resampling filter set as DeltaModulation builds it. */
+    struct ResamplerTier
+    {
+        const char* name;
+        bool offline, minimumPhase;
+    };
+
+    const std::array<ResamplerTier, 3> resamplerTiers
+    {{
+        { "realtime",    false, false },
+        { "offline",     true,  false },
+        { "low_latency", false, true },
+    }};
+
+    constexpr int resamplerTestBlockSize = 256;
+    constexpr int resamplerTestFrequencies = 24;
+    constexpr double resamplerTestSeconds = 0.25;
+
+    template <typename SampleType>
+    void prepareResampler (PolyphaseResampler<SampleType>& resampler, const ResamplerTier& tier, double sampleRate)
+    {
+        using Quality = typename DeltaModulation<SampleType>::Quality;
+        const auto quality = tier.offline ? Quality::Offline : Quality::Realtime;
+
+        resampler.prepare({ sampleRate, static_cast<juce::uint32>(resamplerTestBlockSize), 1 }, DeltaModulation<SampleType>::getOversampledRate(),
+                          DeltaModulation<SampleType>::getResamplerTaps(quality), DeltaModulation<SampleType>::getResamplerAttenuation(quality),
+                          tier.minimumPhase ? PolyphaseResampler<SampleType>::Phase::Minimum : PolyphaseResampler<SampleType>::Phase::Linear);
+    }
+
+    struct SineFit
+    {
+        double amplitude = 0.0, phase = 0.0, residual = 0.0;
+    };
+
+    /** The sine at frequency (cycles per sample) plus a constant that fits x best (least squares), with the
+        sine's phase at x[0] and the RMS of what is left.
+    */
+    SineFit fitSine (const std::vector<double>& x, double frequency)
+    {
+        // normal equations for x[i] = a sin + b cos + d
+        double ss = 0.0, cc = 0.0, sc = 0.0, s1 = 0.0, c1 = 0.0, xs = 0.0, xc = 0.0, x1 = 0.0;
+        for(size_t i = 0; i < x.size(); ++i)
+        {
+            const auto s = std::sin(juce::MathConstants<double>::twoPi * frequency * static_cast<double>(i));
+            const auto c = std::cos(juce::MathConstants<double>::twoPi * frequency * static_cast<double>(i));
+            ss += s * s; cc += c * c; sc += s * c;
+            s1 += s; c1 += c;
+            xs += x[i] * s; xc += x[i] * c; x1 += x[i];
+        }
+        const auto n = static_cast<double>(x.size());
+
+        // determinant of the 3x3 matrix with rows (m00, m01, m02), (m10, m11, m12), (m20, m21, m22)
+        auto det = [] (double m00, double m01, double m02, double m10, double m11, double m12, double m20, double m21, double m22)
+        {
+            return m00 * (m11 * m22 - m12 * m21) - m01 * (m10 * m22 - m12 * m20) + m02 * (m10 * m21 - m11 * m20);
+        };
+
+        // Cramer's rule
+        const auto m = det(ss, sc, s1, sc, cc, c1, s1, c1, n);
+        const auto a = det(xs, sc, s1, xc, cc, c1, x1, c1, n) / m;
+        const auto b = det(ss, xs, s1, sc, xc, c1, s1, x1, n) / m;
+        const auto d = det(ss, sc, xs, sc, cc, xc, s1, c1, x1) / m;
+
+        auto residual = 0.0;
+        for(size_t i = 0; i < x.size(); ++i)
+        {
+            const auto t = juce::MathConstants<double>::twoPi * frequency * static_cast<double>(i);
+            const auto error = x[i] - a * std::sin(t) - b * std::cos(t) - d;
+            residual += error * error;
+        }
+
+        // a sin + b cos = amplitude * sin(t + phase)
+        return { std::sqrt(a * a + b * b), std::atan2(b, a), std::sqrt(residual / juce::jmax(1.0, n)) };
+    }
+
+    double toDecibels (double gain)
+    {
+        return 20.0 * std::log10(juce::jmax(gain, 1.0e-20));
+    }
+
+    /** Loudest a unit sine above the host Nyquist frequency at the high rate comes out of the downsampler, in dB. */
+    template <typename SampleType>
+    double measureAliasing (const ResamplerTier& tier, double sampleRate)
+    {
+        const auto highRate = DeltaModulation<SampleType>::getOversampledRate();
+        const auto numSamples = static_cast<int>(resamplerTestSeconds * sampleRate);
+        auto worst = -400.0;
+
+        for(int k = 0; k < resamplerTestFrequencies; ++k)
+        {
+            const auto frequency = (0.5 * sampleRate + (0.5 * highRate - 0.5 * sampleRate) * k / (resamplerTestFrequencies - 1)) / highRate;
+
+            PolyphaseResampler<SampleType> resampler;
+            prepareResampler(resampler, tier, sampleRate);
+
+            juce::AudioBuffer<SampleType> buffer(1, resamplerTestBlockSize);
+            juce::int64 highRatePosition = 0;
+            double sumSquares = 0.0;
+            int numMeasured = 0;
+
+            for(int start = 0; start < numSamples; start += resamplerTestBlockSize)
+            {
+                buffer.clear();
+                auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubBlock(0, static_cast<size_t>(juce::jmin(resamplerTestBlockSize, numSamples - start)));
+
+                // the host input is silent, the sine stands in for whatever the process adds at the high rate
+                auto highRateBlock = resampler.processSamplesUp(block);
+                for(size_t i = 0; i < highRateBlock.getNumSamples(); ++i) {
+                    highRateBlock.setSample(0, static_cast<int>(i), static_cast<SampleType>(std::sin(juce::MathConstants<double>::twoPi * frequency * static_cast<double>(highRatePosition + static_cast<juce::int64>(i)))));
+                }
+                highRatePosition += static_cast<juce::int64>(highRateBlock.getNumSamples());
+
+                resampler.processSamplesDown(block);
+
+                // skip the first half, while the filters fill
+                if(start >= numSamples / 2)
+                {
+                    for(size_t i = 0; i < block.getNumSamples(); ++i) {
+                        sumSquares += juce::square(static_cast<double>(block.getSample(0, static_cast<int>(i))));
+                        ++numMeasured;
+                    }
+                }
+            }
+
+            worst = juce::jmax(worst, toDecibels(std::sqrt(2.0 * sumSquares / juce::jmax(1, numMeasured))));
+        }
+
+        return worst;
+    }
+
+    struct ImagingResult
+    {
+        double worstResidual = -400.0, worstPassbandDeviation = 0.0;
+    };
+
+    /** Loudest high rate residual besides the sine itself for unit sines across the passband, in dB, and the
+        furthest the round trip gain at those frequencies strays from unity, in dB.
+    */
+    template <typename SampleType>
+    ImagingResult measureImaging (const ResamplerTier& tier, double sampleRate)
+    {
+        const auto passband = DeltaModulation<SampleType>::getResamplerPassband();
+        const auto highRate = DeltaModulation<SampleType>::getOversampledRate();
+        const auto numSamples = static_cast<int>(resamplerTestSeconds * sampleRate);
+        ImagingResult result;
+
+        for(int k = 1; k <= resamplerTestFrequencies; ++k)
+        {
+            const auto frequency = passband * k / resamplerTestFrequencies;
+
+            PolyphaseResampler<SampleType> resampler;
+            prepareResampler(resampler, tier, sampleRate);
+
+            juce::AudioBuffer<SampleType> buffer(1, resamplerTestBlockSize);
+            std::vector<double> highRateOutput, hostOutput;
+
+            for(int start = 0; start < numSamples; start += resamplerTestBlockSize)
+            {
+                const auto length = juce::jmin(resamplerTestBlockSize, numSamples - start);
+                for(int i = 0; i < length; ++i) {
+                    buffer.setSample(0, i, static_cast<SampleType>(std::sin(juce::MathConstants<double>::twoPi * frequency * (start + i))));
+                }
+
+                auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubBlock(0, static_cast<size_t>(length));
+                const auto highRateBlock = resampler.processSamplesUp(block);
+
+                if(start >= numSamples / 2)
+                {
+                    for(size_t i = 0; i < highRateBlock.getNumSamples(); ++i) {
+                        highRateOutput.push_back(static_cast<double>(highRateBlock.getSample(0, static_cast<int>(i))));
+                    }
+                }
+
+                resampler.processSamplesDown(block);
+
+                if(start >= numSamples / 2)
+                {
+                    for(int i = 0; i < length; ++i) {
+                        hostOutput.push_back(static_cast<double>(block.getSample(0, i)));
+                    }
+                }
+            }
+
+            const auto fit = fitSine(highRateOutput, frequency * sampleRate / highRate);
+            result.worstResidual = juce::jmax(result.worstResidual, toDecibels(std::sqrt(2.0) * fit.residual / fit.amplitude));
+
+            const auto deviation = toDecibels(fitSine(hostOutput, frequency).amplitude);
+            result.worstPassbandDeviation = std::abs(deviation) > std::abs(result.worstPassbandDeviation) ? deviation : result.worstPassbandDeviation;
+        }
+
+        return result;
+    }
+
+    template <typename SampleType>
+    void runResamplerChecks (Settings& settings)
+    {
+        using Quality = typename DeltaModulation<SampleType>::Quality;
+
+        for(auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+        for(const auto& tier : resamplerTiers)
+        {
+            const auto quality = tier.offline ? Quality::Offline : Quality::Realtime;
+            const auto limit = -DeltaModulation<SampleType>::getResamplerAttenuation(quality) + resamplerAttenuationMargin;
+
+            const auto precision = std::is_same_v<SampleType, float> ? "float" : "double";
+
+            const auto aliasing = measureAliasing<SampleType>(tier, sampleRate);
+            const auto imaging = measureImaging<SampleType>(tier, sampleRate);
+
+            for(const auto& [check, level] : { std::pair("resampler_alias", aliasing), std::pair("resampler_image", imaging.worstResidual) })
+            {
+                const auto passed = level <= limit;
+                settings.numFailures += passed ? 0 : 1;
+
+                printRow({ check, precision, tier.name, "", "", "", juce::String(sampleRate, 0), "stopband", juce::String(level, 2),
+                           passed ? "0" : "1", passed ? "pass" : "FAIL" });
+            }
+
+            const auto flat = std::abs(imaging.worstPassbandDeviation) <= resamplerPassbandTolerance;
+            settings.numFailures += flat ? 0 : 1;
+
+            printRow({ "resampler_passband", precision, tier.name, "", "", "", juce::String(sampleRate, 0), "unity",
+                       juce::String(imaging.worstPassbandDeviation, 4), flat ? "0" : "1", flat ? "pass" : "FAIL" });
+        }
+    }
+
+    //==============================================================================
+    /** An engine and filter setup the plugin can run, checked at host rates that need resampling. */
+    struct EngineVariant
+    {
+        const char* name;
+        bool tickSampled, offline, lowLatency, linearPhaseSteps;
+
+        /** Minimum phase filters move the sine by their group delay, which isn't reported as latency. */
+        bool isMinimumPhase() const { return tickSampled ? !linearPhaseSteps : lowLatency; }
+    };
+
+    const std::array<EngineVariant, 6> engineVariants
+    {{
+        { "oversampled_realtime",    false, false, false, false },
+        { "oversampled_offline",     false, true,  false, false },
+        { "oversampled_low_latency", false, false, true,  false },
+        { "tick_realtime",           true,  false, false, false },
+        { "tick_offline",            true,  true,  false, false },
+        { "tick_linear_steps",       true,  false, false, true },
+    }};
+
+    constexpr int variantMaxBlockSize = 512;
+    constexpr double spectralTruthRate = 192000.0;
+
+    template <typename SampleType>
+    using Render = std::pair<juce::AudioBuffer<SampleType>, int>;
+
+    /** Renders the signal through a variant, in blocks of blockLength. Returns the render and the reported latency. */
+    template <typename SampleType>
+    Render<SampleType> renderVariant (const EngineVariant& variant, const TestSignal& signal, double sampleRate,
+                                                                 bool pal, int srIndex, int blockLength)
+    {
+        using Processor = DeltaModulation<SampleType>;
+
+        Processor processor;
+        processor.setEngine(variant.tickSampled ? Processor::Engine::TickSampled : Processor::Engine::Oversampled);
+        processor.setStepShape(variant.linearPhaseSteps ? Processor::StepShape::LinearPhase : Processor::StepShape::MinimumPhase);
+        processor.prepare({ sampleRate, static_cast<juce::uint32>(variantMaxBlockSize), numChannels });
+
+        // switched after prepare(), the way the plugin switches them
+        processor.setQuality(variant.offline ? Processor::Quality::Offline : Processor::Quality::Realtime);
+        processor.setLowLatency(variant.lowLatency);
+        configure(processor, pal, srIndex, true);
+
+        auto buffer = makeInput<SampleType>(signal, sampleRate);
+        render(processor, buffer, false, blockLength);
+        return { std::move(buffer), processor.getLatencyInSamples() };
+    }
+
+    /** The sine in the second half of the render with latency samples taken off the front, with its phase at time 0. */
+    template <typename SampleType>
+    SineFit fitOutput (const juce::AudioBuffer<SampleType>& buffer, int channel, double frequency, double sampleRate, int latency)
+    {
+        const auto start = buffer.getNumSamples() / 2;
+
+        std::vector<double> x;
+        for(int s = start + latency; s < buffer.getNumSamples(); ++s) {
+            x.push_back(static_cast<double>(buffer.getSample(channel, s)));
+        }
+
+        auto fit = fitSine(x, frequency / sampleRate);
+        fit.phase -= juce::MathConstants<double>::twoPi * frequency * start / sampleRate;
+        return fit;
+    }
+
+    /** Runs the blocks check, the golden check and, against truth, the spectral check for one variant and signal. */
+    template <typename SampleType>
+    void runVariantCase (Settings& settings, const EngineVariant& variant, const TestSignal& signal, double sampleRate, bool pal, int srIndex,
+                         const Render<SampleType>* truth)
+    {
+        const auto [output, latency] = renderVariant<SampleType>(variant, signal, sampleRate, pal, srIndex, blockSize);
+
+        juce::StringArray caseName;
+        caseName.add("blocks");
+        caseName.add(std::is_same_v<SampleType, float> ? "float" : "double");
+        caseName.add(juce::String(variant.name) + "_" + signal.name);
+        caseName.add(pal ? "pal" : "ntsc");
+        caseName.add(juce::String(srIndex));
+        caseName.add("1");
+        caseName.add(juce::String(sampleRate, 0));
+
+        // single samples and the largest prepared block have to give the same output as blockSize
+        Comparison blocks;
+        for(auto blockLength : { 1, variantMaxBlockSize })
+        {
+            const auto result = compare(output, renderVariant<SampleType>(variant, signal, sampleRate, pal, srIndex, blockLength).first, blockSplitTolerance);
+            blocks.maxError = juce::jmax(blocks.maxError, result.maxError);
+            blocks.numMismatches += result.numMismatches;
+        }
+
+        const auto blocksPassed = blocks.numMismatches == 0;
+        settings.numFailures += blocksPassed ? 0 : 1;
+
+        auto row = caseName;
+        row.add("block_" + juce::String(blockSize));
+        row.add(juce::String(blocks.maxError, 17));
+        row.add(juce::String(blocks.numMismatches));
+        row.add(blocksPassed ? "pass" : "FAIL");
+        printRow(row);
+
+        // the variant's own render stands in for the reference, so fast math is checked on the resampling paths too
+        runGoldenCheck(settings, caseName, output, output);
+
+        if(truth == nullptr) {
+            return;
+        }
+
+        auto worstGain = 0.0, worstDelay = 0.0;
+        for(int c = 0; c < numChannels; ++c)
+        {
+            const auto frequency = signal.getFrequency(c);
+            const auto expected = fitOutput(truth->first, c, frequency, spectralTruthRate, truth->second);
+            const auto actual = fitOutput(output, c, frequency, sampleRate, latency);
+
+            // host samples the output lags the truth by, after the reported latency is taken off
+            const auto delay = std::remainder(expected.phase - actual.phase, juce::MathConstants<double>::twoPi)
+                             / (juce::MathConstants<double>::twoPi * frequency) * sampleRate;
+
+            const auto gain = toDecibels(actual.amplitude / expected.amplitude);
+            worstGain = std::abs(gain) > std::abs(worstGain) ? gain : worstGain;
+            worstDelay = std::abs(delay) > std::abs(worstDelay) ? delay : worstDelay;
+        }
+
+        const auto maxDelay = variant.isMinimumPhase() ? minimumPhaseMaxDelay : spectralDelayTolerance;
+        const auto delayPassed = worstDelay >= -spectralDelayTolerance && worstDelay <= maxDelay;
+        const auto gainPassed = std::abs(worstGain) <= spectralGainTolerance;
+        settings.numFailures += (gainPassed ? 0 : 1) + (delayPassed ? 0 : 1);
+
+        const auto against = "oversampled_" + juce::String(spectralTruthRate, 0);
+
+        caseName.set(0, "spectral_gain");
+        row = caseName;
+        row.add(against);
+        row.add(juce::String(worstGain, 4));
+        row.add(gainPassed ? "0" : "1");
+        row.add(gainPassed ? "pass" : "FAIL");
+        printRow(row);
+
+        caseName.set(0, "spectral_delay");
+        row = caseName;
+        row.add(against);
+        row.add(juce::String(worstDelay, 4));
+        row.add(delayPassed ? "0" : "1");
+        row.add(delayPassed ? "pass" : "FAIL");
+        printRow(row);
+    }
+
+    template <typename SampleType>
+    void runVariantChecks (Settings& settings)
+    {
+        constexpr auto pal = true;
+
+        for(auto srIndex : { 0, 7, 15 })
+        for(const auto& signal : testSignals)
+        {
+            // the plain Oversampled engine at a rate that needs no resampling, which the chain check holds to the reference
+            std::optional<Render<SampleType>> truth;
+            if(signal.keepsGateOpen) {
+                truth = renderVariant<SampleType>(engineVariants[0], signal, spectralTruthRate, pal, srIndex, blockSize);
+            }
+
+            for(auto sampleRate : { 44100.0, 48000.0, 96000.0 })
+            for(const auto& variant : engineVariants) {
+                runVariantCase<SampleType>(settings, variant, signal, sampleRate, pal, srIndex, truth.has_value() ? &*truth : nullptr);
+            }
+        }
+    }
+
+    template <typename SampleType>
+    void runAllCases (Settings& settings)
+    {
+        runGateCurveCheck<SampleType>(settings);
+        runResamplerChecks<SampleType>(settings);
+        runVariantChecks<SampleType>(settings);
+
+        for(auto pal : { true, false })
+        for(int srIndex = 0; srIndex < 16; ++srIndex)
+        {
+            for(const auto& signal : testSignals)
+            {
+                // quantiser checks run at a rate that needs no resampling, so processQuantiser() sees the host rate
+                runCase<SampleType>(settings, signal.keepsGateOpen ? Check::Counter : Check::Quantiser, signal, 192000.0, pal, srIndex, true);
+
+                for(auto sampleRate : { 176400.0, 192000.0 })
+                for(auto antiAliasing : { true, false }) {
+                    runCase<SampleType>(settings, Check::Chain, signal, sampleRate, pal, srIndex, antiAliasing);
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+int runVerification (const juce::ArgumentList& args)
+{
+    Settings settings;
+
+    if(args.containsOption("--write-golden"))
+    {
+        settings.writeGoldenDirectory = args.getFileForOption("--write-golden");
+        settings.writeGoldenDirectory.createDirectory();
+    }
+
+    if(args.containsOption("--golden")) {
+        settings.readGoldenDirectory = args.getFileForOption("--golden");
+    }
+
+    printRow({ "check", "precision", "signal", "system", "sr_index", "anti_aliasing", "host_rate", "against", "error", "mismatches", "result" });
+
+    runAllCases<float>(settings);
+    runAllCases<double>(settings);
+
+    std::cout << (settings.numFailures == 0 ? "All checks passed" : juce::String(settings.numFailures) + " checks failed") << std::endl;
+    return settings.numFailures == 0 ? 0 : 1;
+}
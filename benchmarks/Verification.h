@@ -0,0 +1,103 @@
+#pragma once
+#include <juce_core/juce_core.h>
+#include <limits>
+
+/** Checks DeltaModulation against the frozen reference in ReferenceDeltaModulation.h.
+
+    For float and double, the gate curve (GateCurve) is first swept against std::pow and has to stay
+    within its documented relative error bound (the error column is that bound). Then three checks run
+    for float and double, PAL and NTSC, and every sample rate index:
+
+    - counter: the quantiser alone (processQuantiser) on signals that keep the gate fully open, so the
+      output is the 7-bit counter level itself. Every step has to land on the same sample at the same
+      level: the tolerance (counterTolerance) only allows for the level being scaled by a reciprocal
+      instead of a division, and is thousands of times smaller than one counter step.
+    - quantiser: the quantiser alone on signals that open and close the gate. Allowed error is
+      quantiserTolerance, which covers the GateCurve bound against std::pow.
+    - chain: the full process() at 176.4kHz and 192kHz (where no resampling is needed, so both
+      implementations run the same filters), anti-aliasing on and off, with the same tolerance.
+
+    The Oversampled engine's resampling filters are measured on their own at 44.1kHz, 48kHz and 96kHz,
+    for every quality tier and the low latency (minimum phase) filters:
+
+    - resampler_alias: sines between the host and the high rate Nyquist frequencies are written into
+      the high rate block, and the loudest that comes out of the downsampler is the error column (dB
+      relative to the sine).
+    - resampler_image: sines across the passband go through the upsampler, and the loudest high rate
+      residual besides the sine itself (images and interpolation error) is the error column.
+
+    Both have to stay below minus the tier's design attenuation (DeltaModulation::getResamplerAttenuation())
+    plus resamplerAttenuationMargin.
+
+    - resampler_passband: the same sines, up to DeltaModulation::getResamplerPassband(), back through the
+      downsampler. The round trip gain furthest from unity (the error column, in dB) has to be within
+      resamplerPassbandTolerance, so every tier stays flat as far as the passband claims.
+
+    Every engine variant the plugin can run (the Oversampled engine in each quality tier and with low latency
+    filters, the TickSampled engine in each tier and with linear phase steps) is then run through process()
+    at 44.1kHz, 48kHz and 96kHz, PAL, sample rate indices 0, 7 and 15:
+
+    - blocks: the render in blocks of 97 against renders in single samples and in the largest prepared
+      block. Within blockSplitTolerance, which is zero: block boundaries must not change the output.
+    - spectral_gain and spectral_delay: for the gate-open sines, the sine in the output (after taking off
+      getLatencyInSamples()) against the sine the Oversampled engine puts out at 192kHz, where the chain
+      check holds it to the reference. The gain (the error column, in dB) has to be within
+      spectralGainTolerance. The delay (in host samples) has to be within spectralDelayTolerance, or for
+      minimum phase filters, which delay the sine without reporting it as latency, between
+      -spectralDelayTolerance and minimumPhaseMaxDelay.
+
+    With --write-golden <dir> the reference renders (and the blocks renders) are also written to disk,
+    and with --golden <dir> the optimised renders are compared against renders written by another build,
+    for example a Release build, which uses -Ofast, against a Debug one. cmake/VerifyFastMath.cmake builds
+    both and runs that comparison (or build the VerifyFastMath target). Fast math may move a single
+    quantiser decision, after which the counter takes a different but equally valid path, so that
+    comparison is statistical: at most goldenMaxMismatchRatio of the samples may differ by more than
+    goldenSampleTolerance, and the RMS of the difference must stay below goldenMaxRMSError.
+
+    Those goldens only compare two builds of the same tree. The renders the engine is held to from one commit
+    to the next are committed under tests/golden and checked by tests/GoldenRenders.cpp. CTest runs both
+    (see cmake/Tests.cmake).
+
+    Returns 0 if everything passed.
+*/
+int runVerification (const juce::ArgumentList& args);
+
+/** Tolerances, see runVerification(). */
+template <typename SampleType>
+constexpr double counterTolerance = 4.0 * std::numeric_limits<SampleType>::epsilon();
+
+template <typename SampleType>
+constexpr double quantiserTolerance = std::is_same_v<SampleType, float> ? 1.0e-5 : 1.0e-12;
+
+/** How far short of its design attenuation a resampling filter may measure, in dB. Kaiser's width estimate
+    and the interpolation between tabulated phases each land within a few dB of the target.
+*/
+constexpr double resamplerAttenuationMargin = 5.0;
+
+/** How far the resamplers' round trip gain may stray from unity inside the passband, in dB. */
+constexpr double resamplerPassbandTolerance = 0.01;
+
+/** The output may not depend on how the host splits it into blocks, not even by rounding. */
+constexpr double blockSplitTolerance = 0.0;
+
+/** Gain of the quantised sine against the 192kHz render, in dB. The quantisation noise moves the fitted
+    sine by up to about 0.1dB between host rates.
+*/
+constexpr double spectralGainTolerance = 0.25;
+
+/** Delay against the 192kHz render, in host samples. The quantiser clock lands on a different grid at each rate,
+    which moves the steps by up to about half a host sample; a misreported latency moves the sine by a whole one.
+*/
+constexpr double spectralDelayTolerance = 0.75;
+
+/** Group delay a minimum phase variant may add at the test frequencies, in host samples. The low latency
+    resampling filters measure about 5 and the minBLEP steps about 3.
+*/
+constexpr double minimumPhaseMaxDelay = 8.0;
+
+constexpr double goldenSampleTolerance  = 1.0e-4;
+constexpr double goldenMaxMismatchRatio = 1.0e-3;
+constexpr double goldenMaxRMSError      = 1.0e-3;
+
+/** Points in the gate curve sweep over [0, 1]. */
+constexpr int gateCurveSweepPoints = 1 << 16;
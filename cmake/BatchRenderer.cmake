@@ -0,0 +1,19 @@
+# Headless batch renderer, runs audio files through the full plugin without a host
+file(GLOB_RECURSE BatchRendererFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/tools/BatchRenderer/*.cpp" "${CMAKE_CURRENT_SOURCE_DIR}/tools/BatchRenderer/*.h")
+
+# Organize the renderer source in the tools/BatchRenderer/ folder in the IDE
+source_group(TREE ${CMAKE_CURRENT_SOURCE_DIR}/tools/BatchRenderer PREFIX "" FILES ${BatchRendererFiles})
+
+juce_add_console_app(BatchRenderer PRODUCT_NAME "${PRODUCT_NAME} Batch Renderer")
+target_sources(BatchRenderer PRIVATE ${BatchRendererFiles})
+
+# The renderer drives AudioPluginAudioProcessor directly...
+target_include_directories(BatchRenderer PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/source)
+target_link_libraries(BatchRenderer PRIVATE SharedCode)
+
+# ...which expects the defines the plugin targets normally get
+target_compile_definitions(BatchRenderer PRIVATE
+    JucePlugin_Name="${PRODUCT_NAME}"
+    JUCE_MODAL_LOOPS_PERMITTED=1)
+
+set_target_properties(BatchRenderer PROPERTIES XCODE_GENERATE_SCHEME ON)
@@ -0,0 +1,29 @@
+# Headless DSP benchmark (and, later, other checks that drive the DSP core without a host)
+file(GLOB_RECURSE BenchmarkFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/benchmarks/*.cpp" "${CMAKE_CURRENT_SOURCE_DIR}/benchmarks/*.h")
+
+# Organize the benchmark source in the benchmarks/ folder in the IDE
+source_group(TREE ${CMAKE_CURRENT_SOURCE_DIR}/benchmarks PREFIX "" FILES ${BenchmarkFiles})
+
+juce_add_console_app(Benchmarks PRODUCT_NAME "${PRODUCT_NAME} Benchmarks")
+target_sources(Benchmarks PRIVATE ${BenchmarkFiles})
+
+# The benchmark wants to know about our plugin code...
+target_include_directories(Benchmarks PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/source)
+target_link_libraries(Benchmarks PRIVATE SharedCode)
+
+# ...which expects the defines the plugin targets normally get
+target_compile_definitions(Benchmarks PRIVATE
+    JucePlugin_Name="${PRODUCT_NAME}"
+    JUCE_MODAL_LOOPS_PERMITTED=1)
+
+set_target_properties(Benchmarks PROPERTIES XCODE_GENERATE_SCHEME ON)
+
+# Builds Debug and Release Benchmarks in their own trees and checks the fast math renders against the strict ones
+add_custom_target(VerifyFastMath
+    COMMAND ${CMAKE_COMMAND}
+        -D SOURCE_DIR=${CMAKE_CURRENT_SOURCE_DIR}
+        -D BUILD_ROOT=${CMAKE_CURRENT_BINARY_DIR}/VerifyFastMath
+        -D GENERATOR=${CMAKE_GENERATOR}
+        -P ${CMAKE_CURRENT_SOURCE_DIR}/cmake/VerifyFastMath.cmake
+    USES_TERMINAL
+    VERBATIM)
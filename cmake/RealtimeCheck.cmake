@@ -0,0 +1,19 @@
+# Realtime safety check, catches allocations and locks on the audio thread while sweeping parameters
+file(GLOB_RECURSE RealtimeCheckFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/tools/RealtimeCheck/*.cpp" "${CMAKE_CURRENT_SOURCE_DIR}/tools/RealtimeCheck/*.h")
+
+# Organize the checker source in the tools/RealtimeCheck/ folder in the IDE
+source_group(TREE ${CMAKE_CURRENT_SOURCE_DIR}/tools/RealtimeCheck PREFIX "" FILES ${RealtimeCheckFiles})
+
+juce_add_console_app(RealtimeCheck PRODUCT_NAME "${PRODUCT_NAME} Realtime Check")
+target_sources(RealtimeCheck PRIVATE ${RealtimeCheckFiles})
+
+# The checker drives AudioPluginAudioProcessor directly...
+target_include_directories(RealtimeCheck PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/source)
+target_link_libraries(RealtimeCheck PRIVATE SharedCode ${CMAKE_DL_LIBS})
+
+# ...which expects the defines the plugin targets normally get
+target_compile_definitions(RealtimeCheck PRIVATE
+    JucePlugin_Name="${PRODUCT_NAME}"
+    JUCE_MODAL_LOOPS_PERMITTED=1)
+
+set_target_properties(RealtimeCheck PROPERTIES XCODE_GENERATE_SCHEME ON)
@@ -0,0 +1,28 @@
+# Tests, run with ctest from the build directory
+enable_testing()
+
+file(GLOB_RECURSE TestFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/tests/*.cpp" "${CMAKE_CURRENT_SOURCE_DIR}/tests/*.h")
+
+# Organize the test source in the tests/ folder in the IDE
+source_group(TREE ${CMAKE_CURRENT_SOURCE_DIR}/tests PREFIX "" FILES ${TestFiles})
+
+juce_add_console_app(Tests PRODUCT_NAME "${PRODUCT_NAME} Tests")
+target_sources(Tests PRIVATE ${TestFiles})
+
+# The tests drive the DSP code directly...
+target_include_directories(Tests PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/source)
+target_link_libraries(Tests PRIVATE SharedCode)
+
+# ...which expects the defines the plugin targets normally get
+target_compile_definitions(Tests PRIVATE
+    JucePlugin_Name="${PRODUCT_NAME}"
+    JUCE_MODAL_LOOPS_PERMITTED=1)
+
+set_target_properties(Tests PROPERTIES XCODE_GENERATE_SCHEME ON)
+
+# Every engine variant against the renders committed under tests/golden (see tests/GoldenRenders.cpp)
+add_test(NAME GoldenRenders COMMAND Tests --golden ${CMAKE_CURRENT_SOURCE_DIR}/tests/golden)
+
+# The optimised DSP against the reference implementation, and the resampling and spectral checks (see benchmarks/Verification.h)
+add_test(NAME Verification COMMAND Benchmarks --verify)
+set_tests_properties(Verification PROPERTIES TIMEOUT 3600)
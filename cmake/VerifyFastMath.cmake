@@ -0,0 +1,63 @@
+# Checks the fast math build against a strict one (see runVerification() in benchmarks/Verification.h).
+#
+# Builds the Benchmarks target twice, Debug (strict floating point) and Release (-Ofast, or /fp:fast on MSVC,
+# see SharedCodeDefaults), writes golden renders with the Debug build and checks the Release build against them.
+#
+#   cmake -D SOURCE_DIR=<repository> -D BUILD_ROOT=<scratch directory> [-D GENERATOR=<generator>] -P cmake/VerifyFastMath.cmake
+#
+# or build the VerifyFastMath target, which runs this under <build directory>/VerifyFastMath.
+
+if (NOT SOURCE_DIR OR NOT BUILD_ROOT)
+    message(FATAL_ERROR "Usage: cmake -D SOURCE_DIR=<repository> -D BUILD_ROOT=<scratch directory> [-D GENERATOR=<generator>] -P VerifyFastMath.cmake")
+endif ()
+
+set(GoldenDirectory "${BUILD_ROOT}/golden")
+file(REMOVE_RECURSE "${GoldenDirectory}")
+
+foreach (Config Debug Release)
+    set(ConfigBuildDir "${BUILD_ROOT}/${Config}")
+
+    set(GeneratorArgs "")
+    if (GENERATOR)
+        set(GeneratorArgs -G "${GENERATOR}")
+    endif ()
+
+    # CMAKE_BUILD_TYPE for single config generators, --config for multi config ones
+    execute_process(
+        COMMAND "${CMAKE_COMMAND}" -S "${SOURCE_DIR}" -B "${ConfigBuildDir}" ${GeneratorArgs} -DCMAKE_BUILD_TYPE=${Config}
+        RESULT_VARIABLE Result)
+    if (NOT Result EQUAL 0)
+        message(FATAL_ERROR "Configuring the ${Config} build failed")
+    endif ()
+
+    execute_process(
+        COMMAND "${CMAKE_COMMAND}" --build "${ConfigBuildDir}" --config ${Config} --target Benchmarks --parallel
+        RESULT_VARIABLE Result)
+    if (NOT Result EQUAL 0)
+        message(FATAL_ERROR "Building the ${Config} Benchmarks failed")
+    endif ()
+
+    # juce_add_console_app puts the executable under Benchmarks_artefacts/<config>, named after PRODUCT_NAME
+    file(GLOB_RECURSE Executables "${ConfigBuildDir}/Benchmarks_artefacts/${Config}/*Benchmarks" "${ConfigBuildDir}/Benchmarks_artefacts/${Config}/*Benchmarks.exe")
+    list(LENGTH Executables NumExecutables)
+    if (NOT NumExecutables EQUAL 1)
+        message(FATAL_ERROR "Expected one Benchmarks executable in ${ConfigBuildDir}/Benchmarks_artefacts/${Config}, found: ${Executables}")
+    endif ()
+
+    if (Config STREQUAL "Debug")
+        message(STATUS "Writing golden renders with the Debug build")
+        set(GoldenArgs --write-golden "${GoldenDirectory}")
+    else ()
+        message(STATUS "Checking the ${Config} build against the golden renders")
+        set(GoldenArgs --golden "${GoldenDirectory}")
+    endif ()
+
+    execute_process(
+        COMMAND "${Executables}" --verify ${GoldenArgs}
+        RESULT_VARIABLE Result)
+    if (NOT Result EQUAL 0)
+        message(FATAL_ERROR "Verification of the ${Config} build failed")
+    endif ()
+endforeach ()
+
+message(STATUS "The fast math build matches the strict one")
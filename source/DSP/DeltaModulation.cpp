@@ -3,18 +3,11 @@
 template <typename SampleType>
 DeltaModulation<SampleType>::DeltaModulation()
 {
-    RMSFilter.setLevelCalculationType (juce::dsp::BallisticsFilterLevelCalculationType::RMS);
-    RMSFilter.setAttackTime(static_cast<SampleType>(0.0));
-    RMSFilter.setReleaseTime(static_cast<SampleType>(50.0));
-    
-    envelopeFilter.setAttackTime(static_cast<SampleType>(0.0));
-    envelopeFilter.setReleaseTime(static_cast<SampleType>(10.0));
-
     dcPreFilter.setType(juce::dsp::FirstOrderTPTFilterType::highpass);
     dcPostFilter.setType(juce::dsp::FirstOrderTPTFilterType::highpass);
 
-    dcPreFilter.setCutoffFrequency(static_cast<SampleType>(20.0));
-    dcPostFilter.setCutoffFrequency(static_cast<SampleType>(20.0));
+    dcPreFilter.setCutoffFrequency(static_cast<SampleType>(dcCutoff));
+    dcPostFilter.setCutoffFrequency(static_cast<SampleType>(dcCutoff));
 
     highBoost.setFrequency(static_cast<SampleType>(1000.0));
     highBoost.setGainDB(static_cast<SampleType>(6.0));
@@ -28,10 +21,9 @@ void DeltaModulation<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
     jassert (spec.numChannels > 0);
 
     channels = spec.numChannels;
+    hostSampleRate = spec.sampleRate;
 
-    z1.resize(channels);
-    output.resize(channels);
-    clockPhase.resize(channels);
+    lanes.resize((static_cast<size_t>(channels) + laneWidth - 1) / laneWidth);
 
     highBoost.setSampleRate(spec.sampleRate);
     highBoost.setNumChannels(channels);
@@ -52,57 +44,101 @@ void DeltaModulation<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
     dcPreFilter.prepare(spec);
     dcPostFilter.prepare(spec);
 
-    overSampler.numChannels = channels;
-    overSampler.setUsingIntegerLatency(true);
-    overSampler.clearOversamplingStages();
+    maxBlockSize = spec.maximumBlockSize;
+    inputGain.reset(spec.sampleRate, gainSmoothingTime);
+    gainRamp.resize(spec.maximumBlockSize);
 
-    externalSampleRate = spec.sampleRate;
-    if(externalSampleRate >= targetSampleRate)
+    // both engines and both quality tiers are built, so setEngine() and setQuality() can switch between them on the audio thread.
+    // The TickSampled engine stays at the host rate, the kernels do the band limiting at both ends
+    for(auto tier : { Quality::Realtime, Quality::Offline })
     {
-        overSampler.addDummyOversamplingStage();
-    }
-    else
-    {
-        int n = 0;
-        while(externalSampleRate < targetSampleRate)
-        {
-            externalSampleRate *= 2.0;
-            if(n == 0) {
-                overSampler.addOversamplingStage(juce::dsp::Oversampling<SampleType>::FilterType::filterHalfBandFIREquiripple, 0.05f, -90.0f, 0.06f, -75.0f);
-            }
-            else {
-                overSampler.addOversamplingStage(juce::dsp::Oversampling<SampleType>::FilterType::filterHalfBandPolyphaseIIR, 0.1f, -70.0f, 0.12f, -60.0f);
-            }
-            ++n;
-        }
+        const auto index = static_cast<size_t>(tier);
+        const auto numTaps = tier == Quality::Offline ? tickTapsOffline : tickTapsRealtime;
+        const auto stepPhase = stepShape == StepShape::MinimumPhase ? SincKernel<SampleType>::Phase::Minimum
+                                                                    : SincKernel<SampleType>::Phase::Linear;
+        tickKernels[index].design(numTaps, tickPhases, tickCutoff, tickAttenuation);
+        stepKernels[index].design(numTaps, tickPhases, tickCutoff, tickAttenuation, stepPhase);
     }
-    overSampler.initProcessing(spec.maximumBlockSize);
-    auto osSpec = spec;
-    osSpec.sampleRate = externalSampleRate;
-    RMSFilter.prepare(osSpec);
-    envelopeFilter.prepare(osSpec);
 
-    update();
+    tickHistorySize = static_cast<size_t>(tickTapsOffline) + spec.maximumBlockSize;
+    tickHistory.resize(lanes.size() * tickHistorySize);
+    tickRing.resize(lanes.size() * tickRingSize);
+
+    // the Oversampled engine goes straight to the quantiser rate whatever the ratio, at or above it the resampler passes the block through
+    const auto oversampledRate = juce::jmax(spec.sampleRate, targetSampleRate);
+    resampler.prepare(spec, oversampledRate, getResamplerTaps(Quality::Realtime), getResamplerAttenuation(Quality::Realtime));
+    offlineResampler.prepare(spec, oversampledRate, getResamplerTaps(Quality::Offline), getResamplerAttenuation(Quality::Offline));
+    lowLatencyResampler.prepare(spec, oversampledRate, getResamplerTaps(Quality::Realtime), getResamplerAttenuation(Quality::Realtime),
+                                PolyphaseResampler<SampleType>::Phase::Minimum);
+
+    updateEngineRate();
     reset();
 }
 
 template <typename SampleType>
 void DeltaModulation<SampleType>::reset()
 {
-    std::fill(z1.begin(), z1.end(), static_cast<SampleType>(63.0));
-    std::fill(output.begin(), output.end(), static_cast<SampleType>(0.0));
-    std::fill(clockPhase.begin(), clockPhase.end(), 1.0);
+    for(auto& state : lanes)
+    {
+        state.rms      = SIMDType::expand(static_cast<SampleType>(0.0));
+        state.envelope = SIMDType::expand(static_cast<SampleType>(0.0));
+        state.z1       = SIMDType::expand(static_cast<SampleType>(63.0));
+        state.output   = SIMDType::expand(static_cast<SampleType>(0.0));
+    }
+    clockPhase = 1.0;
+
+    resetFilterState();
 
     for(auto& f : aaFilters) {
         f.reset();
     }
     postFilter.reset();
 
-    RMSFilter.reset();
-    envelopeFilter.reset();
     dcPreFilter.reset();
     dcPostFilter.reset();
     highBoost.reset();
+
+    inputGain.setCurrentAndTargetValue(inputGain.getTargetValue());
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::resetFilterState() noexcept
+{
+    std::fill(tickHistory.begin(), tickHistory.end(), SIMDType::expand(static_cast<SampleType>(0.0)));
+    std::fill(tickRing.begin(), tickRing.end(), SIMDType::expand(static_cast<SampleType>(0.0)));
+    tickRingPosition = 0;
+
+    resampler.reset();
+    offlineResampler.reset();
+    lowLatencyResampler.reset();
+}
+
+template <typename SampleType>
+PolyphaseResampler<SampleType>& DeltaModulation<SampleType>::getActiveResampler() noexcept
+{
+    if(lowLatency) {
+        return lowLatencyResampler;
+    }
+    return quality == Quality::Offline ? offlineResampler : resampler;
+}
+
+template <typename SampleType>
+const PolyphaseResampler<SampleType>& DeltaModulation<SampleType>::getActiveResampler() const noexcept
+{
+    return const_cast<DeltaModulation&>(*this).getActiveResampler();
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::updateEngineRate() noexcept
+{
+    externalSampleRate = engine == Engine::TickSampled ? hostSampleRate : juce::jmax(hostSampleRate, targetSampleRate);
+
+    // same one-pole release as juce::dsp::BallisticsFilter, evaluated at the rate the quantiser runs at
+    const auto expFactor = -2.0 * juce::MathConstants<double>::pi * 1000.0 / externalSampleRate;
+    rmsRelease      = static_cast<SampleType>(std::exp(expFactor / rmsReleaseMs));
+    envelopeRelease = static_cast<SampleType>(std::exp(expFactor / envelopeReleaseMs));
+
+    update();
 }
 
 template <typename SampleType>
@@ -116,35 +152,243 @@ void DeltaModulation<SampleType>::update()
 }
 
 template <typename SampleType>
-SampleType DeltaModulation<SampleType>::processSample (int channel, SampleType inputValue)
+void DeltaModulation<SampleType>::followEnvelope (ChannelLanes& state, SIMDType input) const noexcept
+{
+    // RMS then peak ballistics with instant attack: max() picks the attack branch whenever the input is higher
+    const auto squared = input * input;
+    state.rms = SIMDType::max(squared, squared + SIMDType::expand(rmsRelease) * (state.rms - squared));
+    const auto level = sqrtLanes(state.rms);
+    state.envelope = SIMDType::max(level, level + SIMDType::expand(envelopeRelease) * (state.envelope - level));
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::quantise (ChannelLanes& state, SIMDType input) noexcept
 {
-    jassert(channel < channels);
+    const auto one    = SIMDType::expand(static_cast<SampleType>(1.0));
+    const auto factor = SIMDType::expand(bitFactor);
 
-    auto env = RMSFilter.processSample (channel, inputValue);
-    env = envelopeFilter.processSample (channel, env);
+    const auto target = SIMDType::min(SIMDType::expand(bitDepth),
+                                      SIMDType::max(SIMDType::expand(static_cast<SampleType>(0.0)), input * factor + factor));
 
-    if(clockPhase[channel] >= 1.0)
+    // round(target) > z1 is the same test as target >= z1 + 0.5, since z1 is always a whole step
+    const auto stepUp = SIMDType::greaterThanOrEqual(target, state.z1 + SIMDType::expand(static_cast<SampleType>(0.5)));
+    state.z1 += (SIMDType::expand(static_cast<SampleType>(2.0)) & stepUp) - one;
+    state.output = state.z1 * SIMDType::expand(static_cast<SampleType>(1.0) / bitFactor) - one;
+}
+
+template <typename SampleType>
+typename DeltaModulation<SampleType>::SIMDType DeltaModulation<SampleType>::applyGate (const ChannelLanes& state, SIMDType level) noexcept
+{
+    // below the threshold the gate follows the curve, above it the clamp makes the gain exactly 1
+    const auto one = SIMDType::expand(static_cast<SampleType>(1.0));
+    return level * Gate::process(SIMDType::min(one, state.envelope * SIMDType::expand(bitFactor)));
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::processLanes (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples  = block.getNumSamples();
+
+    jassert(numChannels <= lanes.size() * laneWidth);
+
+    alignas(SIMDType::SIMDRegisterSize) SampleType frame[laneWidth];
+    alignas(SIMDType::SIMDRegisterSize) SampleType result[laneWidth];
+    auto endPhase = clockPhase;
+
+    for(size_t group = 0; group * laneWidth < numChannels; ++group)
     {
-        clockPhase[channel] -= 1.0;
+        auto& state = lanes[group];
+        const auto firstChannel = group * laneWidth;
+        const auto numLanes = juce::jmin(laneWidth, numChannels - firstChannel);
+
+        std::array<SampleType*, laneWidth> channelData {};
+        for(size_t l = 0; l < numLanes; ++l) {
+            channelData[l] = block.getChannelPointer(firstChannel + l);
+        }
+
+        // unused lanes just process silence
+        std::fill(std::begin(frame), std::end(frame), static_cast<SampleType>(0.0));
+        auto phase = clockPhase;
+
+        for(size_t i = 0; i < numSamples; ++i)
+        {
+            for(size_t l = 0; l < numLanes; ++l) {
+                frame[l] = channelData[l][i];
+            }
+            const auto x = SIMDType::fromRawArray(frame);
+
+            followEnvelope(state, x);
+
+            if(phase >= 1.0)
+            {
+                phase -= 1.0;
+                quantise(state, x);
+            }
+            phase += clockInc;
 
-        auto x = inputValue * bitFactor;
-        x += bitFactor;
-        x = juce::jlimit(static_cast<SampleType>(0.0), bitDepth, x);
+            applyGate(state, state.output).copyToRawArray(result);
 
-        x = std::round(x) > z1[channel] ? static_cast<SampleType>(1.0) : static_cast<SampleType>(-1.0);
-        x += z1[channel];
+            for(size_t l = 0; l < numLanes; ++l) {
+                channelData[l][i] = result[l];
+            }
+        }
 
-        z1[channel] = x;
-        x = x / bitFactor;
-        x -= static_cast<SampleType>(1.0);
-        output[channel] = x;
+        endPhase = phase;
     }
-    clockPhase[channel] += clockInc;
 
-    auto gain = (env > threshold) ? static_cast<SampleType> (1.0)
-                                  : std::pow (env * bitFactor, gateRatio);
+    clockPhase = endPhase;
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::processTicks (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples  = block.getNumSamples();
+    const auto& tickKernel = tickKernels[static_cast<size_t>(quality)];
+    const auto& stepKernel = stepKernels[static_cast<size_t>(quality)];
+    const auto numTaps = static_cast<size_t>(tickKernel.getNumTaps());
+    constexpr auto ringMask = tickRingSize - 1;
+
+    jassert(numChannels <= lanes.size() * laneWidth);
+    jassert(numSamples + numTaps <= tickHistorySize);
+
+    const auto zero = SIMDType::expand(static_cast<SampleType>(0.0));
+    const auto tickInterval = 1.0 / clockInc;
+    const auto latency = getLatencyInSamples();
+
+    alignas(SIMDType::SIMDRegisterSize) SampleType frame[laneWidth];
+    alignas(SIMDType::SIMDRegisterSize) SampleType result[laneWidth];
+    std::array<SampleType, tickTapsOffline + 1> coefficients;
+
+    auto endPhase = clockPhase;
+    auto endRingPosition = tickRingPosition;
+
+    for(size_t group = 0; group * laneWidth < numChannels; ++group)
+    {
+        auto& state = lanes[group];
+        auto* history = tickHistory.data() + group * tickHistorySize;
+        auto* ring = tickRing.data() + group * tickRingSize;
+
+        const auto firstChannel = group * laneWidth;
+        const auto numLanes = juce::jmin(laneWidth, numChannels - firstChannel);
+
+        std::array<SampleType*, laneWidth> channelData {};
+        for(size_t l = 0; l < numLanes; ++l) {
+            channelData[l] = block.getChannelPointer(firstChannel + l);
+        }
+
+        // append the block behind the numTaps samples kept from the last one, so sample i sits at history[numTaps + i]
+        std::fill(std::begin(frame), std::end(frame), static_cast<SampleType>(0.0));
+        for(size_t i = 0; i < numSamples; ++i)
+        {
+            for(size_t l = 0; l < numLanes; ++l) {
+                frame[l] = channelData[l][i];
+            }
+            history[numTaps + i] = SIMDType::fromRawArray(frame);
+        }
+
+        auto phase = clockPhase;
+        auto ringPosition = tickRingPosition;
 
-    return output[channel] * gain;
+        for(size_t i = 0; i < numSamples; ++i)
+        {
+            // the envelope sees the input delayed by the full latency so the gate lines up with the output
+            followEnvelope(state, history[numTaps - static_cast<size_t>(latency) + i]);
+
+            // ticks falling inside this sample, oldest first
+            auto tickTime = (1.0 - phase) / clockInc;
+            while(tickTime < 1.0)
+            {
+                tickKernel.getInterpolationTaps(tickTime, coefficients.data());
+
+                auto x = zero;
+                for(size_t k = 0; k < numTaps; ++k) {
+                    x += history[i + 1 + k] * SIMDType::expand(coefficients[k]);
+                }
+
+                const auto previous = state.output;
+                quantise(state, x);
+                const auto delta = state.output - previous;
+
+                stepKernel.getStepResidual(tickTime, coefficients.data());
+                for(size_t k = 0; k <= numTaps; ++k) {
+                    ring[(ringPosition + k) & ringMask] += delta * SIMDType::expand(coefficients[k]);
+                }
+
+                phase -= 1.0;
+                tickTime += tickInterval;
+            }
+            phase += clockInc;
+
+            auto& residual = ring[ringPosition];
+            applyGate(state, state.output + residual).copyToRawArray(result);
+            residual = zero;
+            ringPosition = (ringPosition + 1) & ringMask;
+
+            for(size_t l = 0; l < numLanes; ++l) {
+                channelData[l][i] = result[l];
+            }
+        }
+
+        std::copy(history + numSamples, history + numSamples + numTaps, history);
+
+        endPhase = phase;
+        endRingPosition = ringPosition;
+    }
+
+    clockPhase = endPhase;
+    tickRingPosition = endRingPosition;
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::processInputStage (int channel, const SampleType* input, SampleType* output, size_t numSamples, const SampleType* gains) noexcept
+{
+    const auto fixedGain = inputGain.getCurrentValue();
+
+    for(size_t i = 0; i < numSamples; ++i)
+    {
+        auto x = input[i] * (gains != nullptr ? gains[i] : fixedGain);
+
+        if(antiAliasing) {
+            for(auto& f : aaFilters) {
+                x = f.processSample(channel, x);
+            }
+        }
+
+        x = dcPreFilter.processSample(channel, x);
+        output[i] = x + highBoost.processSample(x, channel);
+    }
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::processOutputStage (int channel, SampleType* samples, size_t numSamples) noexcept
+{
+    for(size_t i = 0; i < numSamples; ++i)
+    {
+        auto x = samples[i];
+
+        if(antiAliasing) {
+            x = postFilter.processSample(channel, x);
+        }
+
+        samples[i] = dcPostFilter.processSample(channel, x);
+    }
+}
+
+template <typename SampleType>
+const SampleType* DeltaModulation<SampleType>::getInputGainRamp (size_t numSamples) noexcept
+{
+    if(!inputGain.isSmoothing()) {
+        return nullptr;
+    }
+
+    jassert(numSamples <= gainRamp.size()); // process() never passes more than the prepared block size
+
+    for(size_t i = 0; i < numSamples; ++i) {
+        gainRamp[i] = inputGain.getNextValue();
+    }
+    return gainRamp.data();
 }
 
 template <typename SampleType>
@@ -187,6 +431,81 @@ void DeltaModulation<SampleType>::setAntiAliasing (bool shouldUseAntiAliasing)
     }
 }
 
+template <typename SampleType>
+void DeltaModulation<SampleType>::setInputGain (SampleType newGain)
+{
+    inputGain.setTargetValue(newGain);
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::setEngine (Engine engineToUse)
+{
+    if(engine != engineToUse)
+    {
+        engine = engineToUse;
+        updateEngineRate();
+        resetFilterState();
+    }
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::setQuality (Quality qualityToUse)
+{
+    if(quality != qualityToUse)
+    {
+        quality = qualityToUse;
+        resetFilterState();
+    }
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::setLowLatency (bool shouldUseLowLatency)
+{
+    if(lowLatency != shouldUseLowLatency)
+    {
+        lowLatency = shouldUseLowLatency;
+        getActiveResampler().reset();
+    }
+}
+
+template <typename SampleType>
+void DeltaModulation<SampleType>::setStepShape (StepShape shapeToUse)
+{
+    stepShape = shapeToUse;
+}
+
+template <typename SampleType>
+int DeltaModulation<SampleType>::getLatencyInSamples() const
+{
+    if(engine == Engine::TickSampled) {
+        const auto index = static_cast<size_t>(quality);
+        return tickKernels[index].getLatency() + stepKernels[index].getLatency();
+    }
+    return getActiveResampler().getLatencyInSamples();
+}
+
+template <typename SampleType>
+int DeltaModulation<SampleType>::getMaximumLatencyInSamples() const
+{
+    const auto tickLatency = juce::jmax(tickKernels[0].getLatency() + stepKernels[0].getLatency(),
+                                        tickKernels[1].getLatency() + stepKernels[1].getLatency());
+    return juce::jmax(tickLatency, resampler.getLatencyInSamples(), offlineResampler.getLatencyInSamples(), lowLatencyResampler.getLatencyInSamples());
+}
+
+template <typename SampleType>
+double DeltaModulation<SampleType>::getTailLengthSeconds() const
+{
+    // after the input stops, the RMS detector releases (closing the gate) and the DC blocker rings down;
+    // both are one-pole decays, given here as the time to fall by tailDecayDB
+    constexpr auto twoPi = juce::MathConstants<double>::twoPi;
+    const auto nepers = -tailDecayDB * std::log(10.0) / 20.0;
+
+    const auto rmsTimeConstant = rmsReleaseMs / (1000.0 * twoPi);
+    const auto dcTimeConstant  = 1.0 / (twoPi * dcCutoff);
+
+    return nepers * (rmsTimeConstant + dcTimeConstant) + getLatencyInSamples() / hostSampleRate;
+}
+
 //==============================================================================
 template class DeltaModulation<float>;
 template class DeltaModulation<double>;
@@ -2,6 +2,9 @@
 #include <juce_dsp/juce_dsp.h>
 #include <numbers>
 #include <IA_Filters/EQ/OnePoleEQFilter.hpp>
+#include "GateCurve.h"
+#include "SincKernel.h"
+#include "PolyphaseResampler.h"
 
 template <typename SampleType>
 class DeltaModulation
@@ -13,6 +16,39 @@ public:
         NTSC
     };
 
+    /** How the quantiser reads its input.
+        Oversampled resamples the whole signal to 133kHz (or runs at the host rate above that) and resamples the result back.
+        TickSampled stays at the host rate: the input is interpolated only at the clock ticks and each
+        output step is written back as a band-limited step.
+    */
+    enum struct Engine
+    {
+        Oversampled,
+        TickSampled
+    };
+
+    /** Filter quality. Realtime uses shorter, cheaper resampling filters for tracking and playback,
+        Offline uses longer ones for bounces and renders. In the Oversampled engine both are flat up to
+        getResamplerPassband() of the host rate (so the two sound the same) and keep everything above the
+        host Nyquist frequency out of the host band, Realtime by at least 80dB and Offline by at least
+        110dB (see getResamplerAttenuation()); in the TickSampled engine Offline halves the transition band.
+        The two tiers report different latencies. Both are built in prepare().
+    */
+    enum struct Quality
+    {
+        Realtime,
+        Offline
+    };
+
+    /** Shape of the band-limited steps the TickSampled engine writes to its output.
+        MinimumPhase (minBLEP) has the same spectrum as LinearPhase but adds no latency.
+    */
+    enum struct StepShape
+    {
+        LinearPhase,
+        MinimumPhase
+    };
+
     DeltaModulation();
 
     //==============================================================================
@@ -25,12 +61,73 @@ public:
     /** Sets whether filtering should be applied before and after re-sampling to reduce aliasing*/
     void setAntiAliasing (bool shouldUseAntiAliasing);
 
+    /** Sets the gain applied to the input (linear). Changes are smoothed.*/
+    void setInputGain (SampleType newGain);
+
+    /** Sets the engine to use. Both engines are built in prepare(), so this can be called from the audio thread,
+        but it changes the latency and the new engine's filters start from silence, so fade around it.
+    */
+    void setEngine (Engine engineToUse);
+
+    /** Returns the engine in use.*/
+    Engine getEngine() const { return engine; }
+
+    /** Sets the filter quality tier. Both tiers are built in prepare(), so this can be called from the audio thread,
+        but it changes the latency and the new filters start from silence, so fade around it.
+    */
+    void setQuality (Quality qualityToUse);
+
+    /** Returns the filter quality tier in use.*/
+    Quality getQuality() const { return quality; }
+
+    /** Switches the Oversampled engine to minimum phase resampling filters, which have the same magnitude
+        response but add no latency, for monitoring while tracking. Both filter sets are built in prepare(),
+        so this can be called from the audio thread. The new filters start from silence, so fade around it.
+    */
+    void setLowLatency (bool shouldUseLowLatency);
+
+    /** Sets the output step shape for the TickSampled engine. This changes the latency, so call it before prepare().*/
+    void setStepShape (StepShape shapeToUse);
+
     //==============================================================================
     /** Returns the number of available sample rates to be used with setSampleRate()*/
     int getNumSampleRates() const { return static_cast<int>(srLookupPAL.size()); }
 
     /** Returns the latency produced by the module. Call this after prepare(). Latency may be 0 at higher sample rates.*/
-    int getLatencyInSamples() const { return juce::roundToInt(overSampler.getLatencyInSamples()); }
+    int getLatencyInSamples() const;
+
+    /** Returns the largest latency any engine, quality tier or setLowLatency() setting can have, for sizing delay lines. Call this after prepare().*/
+    int getMaximumLatencyInSamples() const;
+
+    /** Returns how long the output takes to die away once the input goes silent, including the latency. Call this after prepare().*/
+    double getTailLengthSeconds() const;
+
+    /** Level the tail is measured down to. */
+    static constexpr double tailDecayDB = -120.0;
+
+    /** The rate the Oversampled engine runs the quantiser at. */
+    static constexpr double getOversampledRate() noexcept { return targetSampleRate; }
+
+    /** Length at the host rate of the Oversampled engine's resampling filters for a quality tier. */
+    static constexpr int getResamplerTaps (Quality qualityToUse) noexcept
+    {
+        return qualityToUse == Quality::Offline ? resamplerTapsOffline : resamplerTapsRealtime;
+    }
+
+    /** Where the passband of the Oversampled engine's resampling filters ends in every tier, as a share of the host rate
+        (about 20kHz at 44.1kHz, like the half-band filters this engine used to oversample with).
+    */
+    static constexpr double getResamplerPassband() noexcept { return resamplerPassband; }
+
+    /** Stopband attenuation the Oversampled engine's resampling filters are designed for, for a quality tier. */
+    static constexpr double getResamplerAttenuation (Quality qualityToUse) noexcept
+    {
+        return qualityToUse == Quality::Offline ? resamplerAttenuationOffline : resamplerAttenuationRealtime;
+    }
+
+    /** The gate's gain curve. Its error bound is checked by the verification harness, not at runtime. */
+    static constexpr int gateRatio = 50;
+    using Gate = GateCurve<gateRatio>;
 
     //==============================================================================
     /** Initialises the processor. */
@@ -51,63 +148,48 @@ public:
         jassert (inputBlock.getNumChannels() == numChannels);
         jassert (inputBlock.getNumSamples() == outputBlock.getNumSamples());
 
-        outputBlock.copyFrom(inputBlock);
-        if (context.isBypassed) {
-            return;
-        }
+        const auto numSamples = outputBlock.getNumSamples();
 
-        if(antiAliasing)
+        // every buffer below is sized for the prepared block size, longer blocks are processed in pieces
+        if (numSamples > maxBlockSize && maxBlockSize > 0)
         {
-            for(auto& f : aaFilters) {
-                f.process(context);
-            }
-        }
-
-        auto numSamples = outputBlock.getNumSamples();
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* outputSamples = outputBlock.getChannelPointer (channel);
-
-            for (size_t i = 0; i < numSamples; ++i) {
-                outputSamples[i] = dcPreFilter.processSample ((int) channel, outputSamples[i]);
-                outputSamples[i] += highBoost.processSample(outputSamples[i], (int) channel);
+            for (size_t start = 0; start < numSamples; start += maxBlockSize)
+            {
+                const auto length = juce::jmin(maxBlockSize, numSamples - start);
+                auto outputPiece = outputBlock.getSubBlock(start, length);
+
+                if constexpr (ProcessContext::usesSeparateInputAndOutputBlocks()) {
+                    const auto inputPiece = inputBlock.getSubBlock(start, length);
+                    ProcessContext piece(inputPiece, outputPiece);
+                    piece.isBypassed = context.isBypassed;
+                    process(piece);
+                }
+                else {
+                    ProcessContext piece(outputPiece);
+                    piece.isBypassed = context.isBypassed;
+                    process(piece);
+                }
             }
+            return;
         }
 
-        auto osBlock = overSampler.processSamplesUp(outputBlock);
-        numSamples = osBlock.getNumSamples();
-
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* outputSamples = osBlock.getChannelPointer (channel);
-
-            for (size_t i = 0; i < numSamples; ++i) {
-                outputSamples[i] = processSample ((int) channel, outputSamples[i]);
-            }
+        if (context.isBypassed) {
+            outputBlock.copyFrom(inputBlock);
+            inputGain.skip(static_cast<int>(numSamples));
+            return;
         }
 
-        overSampler.processSamplesDown(outputBlock);
-
-        numSamples = outputBlock.getNumSamples();
-        if(antiAliasing)
-        {
-            for (size_t channel = 0; channel < numChannels; ++channel)
-            {
-                auto* outputSamples = outputBlock.getChannelPointer (channel);
+        // host rate work before and after the oversampled section is done in one pass per channel
+        const auto* inputGains = getInputGainRamp(numSamples);
 
-                for (size_t i = 0; i < numSamples; ++i) {
-                    outputSamples[i] = postFilter.processSample ((int) channel, outputSamples[i]);
-                }
-            }
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            processInputStage((int) channel, inputBlock.getChannelPointer(channel), outputBlock.getChannelPointer(channel), numSamples, inputGains);
         }
 
-        for (size_t channel = 0; channel < numChannels; ++channel)
-        {
-            auto* outputSamples = outputBlock.getChannelPointer (channel);
+        processEngine(outputBlock);
 
-            for (size_t i = 0; i < numSamples; ++i) {
-                outputSamples[i] = dcPostFilter.processSample ((int) channel, outputSamples[i]);
-            }
+        for (size_t channel = 0; channel < numChannels; ++channel) {
+            processOutputStage((int) channel, outputBlock.getChannelPointer(channel), numSamples);
         }
 
         if(antiAliasing) {
@@ -120,11 +202,84 @@ public:
         dcPostFilter.snapToZero();
     }
 
+    /** Runs only the engine over the block, in place: the resampling filters around the envelope, clock, quantiser
+        and gate for the Oversampled engine, the tick and step kernels for the TickSampled one. process() runs it
+        between the host rate stages (input gain, filters, DC blockers and high boost), which this leaves out, so
+        the golden render tests only depend on this repository's code. No longer than the prepared block size.
+    */
+    void processEngine (juce::dsp::AudioBlock<SampleType> block) noexcept
+    {
+        jassert (block.getNumSamples() <= maxBlockSize);
+
+        if (engine == Engine::TickSampled)
+        {
+            processTicks(block);
+        }
+        else
+        {
+            auto& activeResampler = getActiveResampler();
+
+            auto osBlock = activeResampler.processSamplesUp(block);
+            processLanes(osBlock);
+
+            activeResampler.processSamplesDown(block);
+        }
+    }
+
+    /** Runs only the envelope, clock, quantiser and gate over the block, in place, with no filtering or resampling.
+        The block is taken to be at the quantiser rate, which is the host rate when prepared at 133kHz or above.
+        Only meant for checking the core against a reference implementation.
+    */
+    void processQuantiser (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        processLanes(block);
+    }
+
 private:
 
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t laneWidth = SIMDType::SIMDNumElements;
+
     void update();
 
-    SampleType processSample (int channel, SampleType inputValue);
+    /** Picks the rate the quantiser runs at for the engine in use and the release coefficients that depend on it. */
+    void updateEngineRate() noexcept;
+
+    /** Runs the envelope, clock, quantiser and gate over the oversampled block,
+        with up to laneWidth channels packed into each SIMD register.
+    */
+    void processLanes (const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    /** Host rate version of processLanes(), only reading the input at the clock ticks. */
+    void processTicks (const juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    /** Input gain, anti-aliasing filters, DC blocker and high boost for one channel. */
+    void processInputStage (int channel, const SampleType* input, SampleType* output, size_t numSamples, const SampleType* gains) noexcept;
+
+    /** Post filter and DC blocker for one channel, in place. */
+    void processOutputStage (int channel, SampleType* samples, size_t numSamples) noexcept;
+
+    /** Fills the gain ramp for this block while the input gain is moving, otherwise returns nullptr. */
+    const SampleType* getInputGainRamp (size_t numSamples) noexcept;
+
+    static SIMDType sqrtLanes (SIMDType x) noexcept
+    {
+        for (size_t l = 0; l < laneWidth; ++l) {
+            x.set(l, std::sqrt(x.get(l)));
+        }
+        return x;
+    }
+
+    struct ChannelLanes;
+
+    /** Advances the RMS and envelope followers by one sample. */
+    void followEnvelope (ChannelLanes& state, SIMDType input) const noexcept;
+
+    /** Runs one clock tick of the quantiser, updating z1 and the output level. */
+    static void quantise (ChannelLanes& state, SIMDType input) noexcept;
+
+    /** Applies the gate to the output level. */
+    static SIMDType applyGate (const ChannelLanes& state, SIMDType level) noexcept;
 
     static constexpr double targetSampleRate = 133000.0;
     static constexpr int numBits             = 7;
@@ -174,24 +329,74 @@ private:
     bool antiAliasing = true;
     int srIndex = 15;
     System system = System::PAL;
-    double externalSampleRate = 48000.0, internalSampleRate = 33252.1;
+    Engine engine = Engine::Oversampled;
+    Quality quality = Quality::Realtime;
+    StepShape stepShape = StepShape::MinimumPhase;
+    double hostSampleRate = 48000.0, externalSampleRate = 48000.0, internalSampleRate = 33252.1;
     double clockInc = 1.0;
 
     int channels = 1;
+    size_t maxBlockSize = 0;
     static constexpr int numFilters = 4;
 
-    static constexpr SampleType threshold = static_cast<SampleType>(1.0) / bitFactor;
-    static constexpr SampleType gateRatio = static_cast<SampleType>(50.0);
+    static constexpr double gainSmoothingTime = 15.0 * 0.0001;
+    juce::LinearSmoothedValue<SampleType> inputGain { static_cast<SampleType>(1.0) };
+    std::vector<SampleType> gainRamp;
+
+
+    // release times for the RMS detector and the envelope that follows it (attack is instant)
+    static constexpr double rmsReleaseMs      = 50.0;
+    static constexpr double envelopeReleaseMs = 10.0;
+    SampleType rmsRelease = static_cast<SampleType>(0.0), envelopeRelease = static_cast<SampleType>(0.0);
 
     IADSP::OnePoleEQFilter<SampleType> highBoost { IADSP::OnePoleEQFilterMode::HighPass };
     std::vector<juce::dsp::StateVariableTPTFilter<SampleType>> aaFilters;
     juce::dsp::StateVariableTPTFilter<SampleType> postFilter;
-    juce::dsp::Oversampling<SampleType> overSampler;
-    juce::dsp::BallisticsFilter<SampleType> envelopeFilter, RMSFilter;
+    PolyphaseResampler<SampleType> resampler, offlineResampler, lowLatencyResampler;
+    bool lowLatency = false;
+
+    PolyphaseResampler<SampleType>& getActiveResampler() noexcept;
+    const PolyphaseResampler<SampleType>& getActiveResampler() const noexcept;
+
+    /** Clears the resampler and tick engine filter state, used when switching between filter sets. */
+    void resetFilterState() noexcept;
+
+    // resampling filter lengths at the host rate (the way back down scales them by the ratio) and stopband
+    // attenuation. The stopband starts at the host Nyquist frequency, so each tier needs enough taps to
+    // fit its transition band between that and the passband edge; Offline's extra taps go into attenuation
+    static constexpr int resamplerTapsRealtime = 104;
+    static constexpr int resamplerTapsOffline  = 144;
+    static constexpr double resamplerAttenuationRealtime = 80.0;
+    static constexpr double resamplerAttenuationOffline  = 110.0;
+    static constexpr double resamplerPassband = 0.45;
+
+    static_assert(0.5 - SincKernel<SampleType>::getTransitionWidth(resamplerTapsRealtime, resamplerAttenuationRealtime) >= resamplerPassband);
+    static_assert(0.5 - SincKernel<SampleType>::getTransitionWidth(resamplerTapsOffline, resamplerAttenuationOffline) >= resamplerPassband);
+
+    static constexpr double dcCutoff = 20.0;
     juce::dsp::FirstOrderTPTFilter<SampleType> dcPreFilter, dcPostFilter;
 
-    std::vector<SampleType> z1;
-    std::vector<SampleType> output;
-    std::vector<double> clockPhase;
+    /** Per-channel state, one lane per channel. The clock is shared since every channel ticks together. */
+    struct ChannelLanes
+    {
+        SIMDType rms, envelope, z1, output;
+    };
+
+    std::vector<ChannelLanes> lanes;
+    double clockPhase = 1.0;
+
+    // TickSampled engine: per group of lanes, the input history (numTaps frames, then the current block)
+    // and a ring of pending step residuals for the output. the tick kernels read the input, the step kernels write the steps.
+    static constexpr int tickTapsRealtime = 16;
+    static constexpr int tickTapsOffline  = 32;
+    static constexpr int tickPhases = 64;
+    static constexpr double tickCutoff = 0.45, tickAttenuation = 90.0;
+    static constexpr size_t tickRingSize = 64;
+    static_assert(tickRingSize > tickTapsOffline && juce::isPowerOfTwo(tickRingSize));
+
+    // one kernel pair per quality tier, indexed by Quality
+    std::array<SincKernel<SampleType>, 2> tickKernels, stepKernels;
+    std::vector<SIMDType> tickHistory, tickRing;
+    size_t tickHistorySize = 0, tickRingPosition = 0;
 
 };
@@ -0,0 +1,72 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include <limits>
+
+/** Gain curve used by the DPCM gate: x^Exponent over [0, 1].
+
+    The power is expanded at compile time into a fixed chain of multiplies (square-and-multiply),
+    so the same code runs on plain samples and on juce::dsp::SIMDRegister lanes, and std::pow is
+    never called on the audio thread. For the gate's exponent of 50 that is 7 multiplies.
+
+    Error bound: every multiply rounds once (at most epsilon / 2 relative) and squaring doubles the
+    error carried in, which for any exponent adds up to (Exponent - 1) * epsilon / 2 relative error
+    against the exact power. isWithinErrorBound() checks this against std::pow, the verification
+    harness (benchmarks/Verification.h) runs it for both sample types.
+*/
+template <int Exponent>
+struct GateCurve
+{
+    static_assert(Exponent > 0, "GateCurve needs a positive exponent");
+
+    /** Returns x^Exponent. Callers clamp x to [0, 1] so the result never exceeds unity. */
+    template <typename ValueType>
+    static ValueType process (ValueType x) noexcept
+    {
+        return power<Exponent>(x);
+    }
+
+    /** Relative error bound of process() against the exact power, for the given sample type. */
+    template <typename SampleType>
+    static constexpr SampleType maxRelativeError()
+    {
+        return static_cast<SampleType>(Exponent - 1) * std::numeric_limits<SampleType>::epsilon() * static_cast<SampleType>(0.5);
+    }
+
+    /** Sweeps [0, 1] and compares process() against std::pow. Far too slow for the audio path, see Verification.h. */
+    template <typename SampleType>
+    static bool isWithinErrorBound (int numPoints = 4096)
+    {
+        // std::pow is allowed its own ulp of slack, and results that underflow are compared absolutely
+        const auto tolerance = maxRelativeError<SampleType>() + std::numeric_limits<SampleType>::epsilon();
+        const auto floor     = std::numeric_limits<SampleType>::min();
+
+        for(int i = 0; i <= numPoints; ++i)
+        {
+            const auto x = static_cast<SampleType>(i) / static_cast<SampleType>(numPoints);
+            const auto reference = std::pow(x, static_cast<SampleType>(Exponent));
+            const auto error = std::abs(process(x) - reference);
+
+            if(error > tolerance * reference + floor) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+
+    template <int N, typename ValueType>
+    static ValueType power (ValueType x) noexcept
+    {
+        if constexpr (N == 1) {
+            return x;
+        }
+        else if constexpr (N % 2 == 0) {
+            const auto h = power<N / 2>(x);
+            return h * h;
+        }
+        else {
+            return x * power<N - 1>(x);
+        }
+    }
+};
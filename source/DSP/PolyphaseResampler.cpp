@@ -0,0 +1,193 @@
+#include "PolyphaseResampler.h"
+
+template <typename SampleType>
+void PolyphaseResampler<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, double highRate, int numTaps, double attenuationDB, Phase phase)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+    jassert (numTaps > 1 && numTaps % 2 == 0);
+
+    numChannels = static_cast<int>(spec.numChannels);
+    const auto maxBlockSize = static_cast<int>(spec.maximumBlockSize);
+
+    ratio = highRate / spec.sampleRate;
+    passThrough = ratio <= 1.0;
+
+    if(passThrough)
+    {
+        ratio = 1.0;
+        latency = 0;
+        upTaps = downTaps = downHistoryLength = 0;
+        readDelay = 0.0;
+
+        // only used to hand the block back from processSamplesUp()
+        upHistory.setSize(numChannels, maxBlockSize);
+        downHistory.setSize(0, 0);
+        reset();
+        return;
+    }
+
+    // both stopbands start at the host Nyquist frequency, 0.5 cycles per host sample or 0.5 / ratio per high rate sample
+    const auto numPhases = getNumPhases(attenuationDB);
+
+    upTaps = numTaps;
+    upKernel.design(upTaps, numPhases, 0.5 - 0.5 * SincKernel<SampleType>::getTransitionWidth(upTaps, attenuationDB), attenuationDB, phase);
+
+    downTaps = 2 * juce::roundToInt(numTaps * ratio * 0.5);
+    downKernel.design(downTaps, numPhases, 0.5 / ratio - 0.5 * SincKernel<SampleType>::getTransitionWidth(downTaps, attenuationDB), attenuationDB, phase);
+
+    coefficients.resize(static_cast<size_t>(juce::jmax(upTaps, downTaps)));
+
+    // round the latency up to whole host samples and make the downsampler read that much further back
+    const auto upLatency = static_cast<double>(upKernel.getLatency());
+    const auto downLatency = static_cast<double>(downKernel.getLatency());
+    latency = static_cast<int>(std::ceil(upLatency + downLatency / ratio - 1.0e-9));
+    readDelay = juce::jmax(0.0, (latency - upLatency) * ratio - downLatency);
+
+    const auto maxHighRateBlockSize = static_cast<int>(std::ceil(maxBlockSize * ratio)) + 1;
+    downHistoryLength = downTaps + static_cast<int>(std::ceil(readDelay)) + 2;
+
+    upHistory.setSize(numChannels, upTaps + maxBlockSize);
+    downHistory.setSize(numChannels, downHistoryLength + maxHighRateBlockSize);
+
+    reset();
+}
+
+template <typename SampleType>
+int PolyphaseResampler<SampleType>::getNumPhases (double attenuationDB) noexcept
+{
+    // linear interpolation between phases is off by about (pi f / numPhases)^2 / 2 at f cycles per sample,
+    // worst at the host Nyquist frequency
+    const auto maxError = juce::Decibels::decibelsToGain(-attenuationDB);
+    const auto needed = juce::MathConstants<double>::pi * 0.5 / std::sqrt(2.0 * maxError);
+    return juce::nextPowerOfTwo(static_cast<int>(std::ceil(needed)));
+}
+
+template <typename SampleType>
+void PolyphaseResampler<SampleType>::reset() noexcept
+{
+    upHistory.clear();
+    downHistory.clear();
+    hostPosition = 0;
+    highRatePosition = 0;
+    numHighRateSamples = 0;
+}
+
+template <typename SampleType>
+juce::dsp::AudioBlock<SampleType> PolyphaseResampler<SampleType>::processSamplesUp (const juce::dsp::AudioBlock<const SampleType>& inputBlock) noexcept
+{
+    const auto channelsToUse = juce::jmin(static_cast<int>(inputBlock.getNumChannels()), numChannels);
+    const auto numSamples = static_cast<int>(inputBlock.getNumSamples());
+
+    if(passThrough)
+    {
+        jassert(numSamples <= upHistory.getNumSamples());
+
+        for(int c = 0; c < channelsToUse; ++c) {
+            juce::FloatVectorOperations::copy(upHistory.getWritePointer(c), inputBlock.getChannelPointer(static_cast<size_t>(c)), numSamples);
+        }
+        numHighRateSamples = numSamples;
+        return juce::dsp::AudioBlock<SampleType>(upHistory).getSubBlock(0, static_cast<size_t>(numSamples))
+                                                            .getSubsetChannelBlock(0, static_cast<size_t>(channelsToUse));
+    }
+
+    jassert(numSamples + upTaps <= upHistory.getNumSamples());
+
+    // host sample i of this block sits at upHistory[upTaps + i]
+    for(int c = 0; c < channelsToUse; ++c) {
+        juce::FloatVectorOperations::copy(upHistory.getWritePointer(c, upTaps), inputBlock.getChannelPointer(static_cast<size_t>(c)), numSamples);
+    }
+
+    // every high rate sample whose host time falls before the end of this block
+    const auto endPosition = static_cast<juce::int64>(std::ceil(static_cast<double>(hostPosition + numSamples) * ratio));
+    numHighRateSamples = static_cast<int>(juce::jlimit(juce::int64(0), static_cast<juce::int64>(downHistory.getNumSamples() - downHistoryLength),
+                                                       endPosition - highRatePosition));
+
+    const auto** input = upHistory.getArrayOfReadPointers();
+    auto** output = downHistory.getArrayOfWritePointers();
+
+    for(int j = 0; j < numHighRateSamples; ++j)
+    {
+        const auto time = static_cast<double>(highRatePosition + j) / ratio - static_cast<double>(hostPosition);
+        const auto index = static_cast<int>(std::floor(time));
+
+        upKernel.getInterpolationTaps(juce::jlimit(0.0, 1.0, time - index), coefficients.data());
+
+        // taps cover samples [index - upTaps + 1, index], which start at upHistory[index + 1]
+        const auto start = index + 1;
+
+        for(int c = 0; c < channelsToUse; ++c)
+        {
+            const auto* x = input[c] + start;
+            auto sum = static_cast<SampleType>(0.0);
+            for(int k = 0; k < upTaps; ++k) {
+                sum += x[k] * coefficients[static_cast<size_t>(k)];
+            }
+            output[c][downHistoryLength + j] = sum;
+        }
+    }
+
+    for(int c = 0; c < channelsToUse; ++c)
+    {
+        auto* history = upHistory.getWritePointer(c);
+        std::copy(history + numSamples, history + numSamples + upTaps, history);
+    }
+
+    hostPosition += numSamples;
+    highRatePosition += numHighRateSamples;
+
+    return juce::dsp::AudioBlock<SampleType>(downHistory).getSubBlock(static_cast<size_t>(downHistoryLength), static_cast<size_t>(numHighRateSamples))
+                                                          .getSubsetChannelBlock(0, static_cast<size_t>(channelsToUse));
+}
+
+template <typename SampleType>
+void PolyphaseResampler<SampleType>::processSamplesDown (juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept
+{
+    const auto channelsToUse = juce::jmin(static_cast<int>(outputBlock.getNumChannels()), numChannels);
+    const auto numSamples = static_cast<int>(outputBlock.getNumSamples());
+
+    if(passThrough)
+    {
+        for(int c = 0; c < channelsToUse; ++c) {
+            juce::FloatVectorOperations::copy(outputBlock.getChannelPointer(static_cast<size_t>(c)), upHistory.getReadPointer(c), numSamples);
+        }
+        return;
+    }
+
+    // high rate sample m of the block from processSamplesUp() sits at downHistory[downHistoryLength + m - firstHighRate]
+    const auto firstHost = hostPosition - numSamples;
+    const auto firstHighRate = highRatePosition - numHighRateSamples;
+    const auto** input = downHistory.getArrayOfReadPointers();
+
+    for(int i = 0; i < numSamples; ++i)
+    {
+        const auto position = static_cast<double>(firstHost + i) * ratio - readDelay;
+        const auto index = static_cast<juce::int64>(std::floor(position));
+
+        downKernel.getInterpolationTaps(juce::jlimit(0.0, 1.0, position - static_cast<double>(index)), coefficients.data());
+
+        // taps cover samples [index - downTaps + 1, index]
+        const auto start = downHistoryLength + static_cast<int>(index - firstHighRate) - downTaps + 1;
+        jassert(start >= 0 && start + downTaps <= downHistoryLength + numHighRateSamples);
+
+        for(int c = 0; c < channelsToUse; ++c)
+        {
+            const auto* x = input[c] + start;
+            auto sum = static_cast<SampleType>(0.0);
+            for(int k = 0; k < downTaps; ++k) {
+                sum += x[k] * coefficients[static_cast<size_t>(k)];
+            }
+            outputBlock.setSample(c, i, sum);
+        }
+    }
+
+    for(int c = 0; c < channelsToUse; ++c)
+    {
+        auto* history = downHistory.getWritePointer(c);
+        std::copy(history + numHighRateSamples, history + numHighRateSamples + downHistoryLength, history);
+    }
+}
+
+//==============================================================================
+template class PolyphaseResampler<float>;
+template class PolyphaseResampler<double>;
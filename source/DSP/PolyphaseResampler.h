@@ -0,0 +1,80 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "SincKernel.h"
+
+/** Resamples a block up to an arbitrary higher rate and back down again, for running a process at a
+    fixed rate whatever the host rate is. Works like juce::dsp::Oversampling (processSamplesUp(),
+    process the returned block, processSamplesDown()) but the ratio doesn't have to be a power of two,
+    so the high rate can sit right on the rate the process needs.
+
+    Both directions are polyphase windowed-sinc filters (SincKernel) read at fractional positions, so
+    any ratio works with the same tables. Upsampling filters at the host rate, downsampling filters at
+    the high rate. Both put the start of their stopband on the host Nyquist frequency, so neither the
+    images of the input nor anything the process adds above the host band fold back into it at more
+    than -attenuationDB; the passband ends one transition width (SincKernel::getTransitionWidth()) lower.
+    The high rate block changes length from one block to the next (by one sample at most);
+    processSamplesUp() returns it at the right length.
+
+    The downsampler reads late enough that the total latency is a whole number of host samples.
+*/
+template <typename SampleType>
+class PolyphaseResampler
+{
+public:
+    using Phase = typename SincKernel<SampleType>::Phase;
+
+    PolyphaseResampler() = default;
+
+    //==============================================================================
+    /** Sets up the filters for going from hostRate to highRate and back. numTaps is the length of the
+        filters at the host rate (even), the downsampler's is scaled up by the ratio. attenuationDB is the
+        stopband attenuation, more of it widens the transition band for the same numTaps. When highRate is
+        not above hostRate, the block is passed straight through. Allocates, so call from prepare().
+    */
+    void prepare (const juce::dsp::ProcessSpec& spec, double highRate, int numTaps, double attenuationDB, Phase phase = Phase::Linear);
+
+    /** Clears all the history. */
+    void reset() noexcept;
+
+    /** Resamples the block up and returns the high rate version, which stays valid until the next call. */
+    juce::dsp::AudioBlock<SampleType> processSamplesUp (const juce::dsp::AudioBlock<const SampleType>& inputBlock) noexcept;
+
+    /** Resamples the block last returned by processSamplesUp() back down into outputBlock, which has to be
+        the same length as the block passed to processSamplesUp().
+    */
+    void processSamplesDown (juce::dsp::AudioBlock<SampleType>& outputBlock) noexcept;
+
+    /** Returns the latency of a round trip in host samples. */
+    int getLatencyInSamples() const noexcept { return latency; }
+
+    /** Returns the high rate divided by the host rate. */
+    double getRatio() const noexcept { return ratio; }
+
+private:
+
+    /** Sub-sample positions to tabulate in the kernels. The rest is interpolated linearly between them,
+        which leaves an error that falls with the square of the number of phases, kept below the stopband.
+    */
+    static int getNumPhases (double attenuationDB) noexcept;
+
+    bool passThrough = true;
+    double ratio = 1.0;
+    int numChannels = 0, latency = 0;
+
+    SincKernel<SampleType> upKernel, downKernel;
+    std::vector<SampleType> coefficients;
+
+    // host rate input, numTaps samples from the last block then the current block
+    juce::AudioBuffer<SampleType> upHistory;
+    int upTaps = 0;
+
+    // high rate samples, downHistoryLength from the last block then the current block
+    juce::AudioBuffer<SampleType> downHistory;
+    int downTaps = 0, downHistoryLength = 0, numHighRateSamples = 0;
+
+    // absolute sample counts, high rate sample m sits at host time m / ratio
+    juce::int64 hostPosition = 0, highRatePosition = 0;
+
+    // where the downsampler reads, in high rate samples behind host time * ratio
+    double readDelay = 0.0;
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <atomic>
+#include "TripleBuffer.h"
+
+/** Reduces the output to the min/max columns the editor's scope draws, on the audio thread.
+
+    Each window of audio is split into numColumns columns and the lowest and highest sample of every
+    column (across all channels) is kept. Once a window is complete it is published through a
+    TripleBuffer, so the editor only ever copies numColumns pairs and neither thread waits.
+    While inactive (no editor open) nothing is reduced at all.
+*/
+class ScopeReducer
+{
+public:
+    static constexpr int numColumns = 60;
+
+    struct Columns
+    {
+        std::array<float, numColumns> min {}, max {};
+    };
+
+    //==============================================================================
+    /** Sets the window length. Call before processing starts. */
+    void prepare (double sampleRate, double windowSeconds) noexcept
+    {
+        samplesPerColumn = juce::jmax(1, juce::roundToInt(sampleRate * windowSeconds / numColumns));
+        wasActive = false;
+    }
+
+    /** Turns reduction on or off. Safe to call from any thread. */
+    void setActive (bool shouldBeActive) noexcept { active.store(shouldBeActive, std::memory_order_relaxed); }
+
+    //==============================================================================
+    /** Audio thread: adds a block. With numChannels 0 the block is taken as silence. */
+    template <typename SampleType>
+    void process (const SampleType* const* channels, int numChannels, int numSamples) noexcept
+    {
+        if(!active.load(std::memory_order_relaxed)) {
+            wasActive = false;
+            return;
+        }
+
+        // start from an empty window, not whatever was left from before the editor closed
+        if(!wasActive) {
+            wasActive = true;
+            column = columnFill = 0;
+        }
+
+        for(int start = 0; start < numSamples;)
+        {
+            const auto chunk = juce::jmin(numSamples - start, samplesPerColumn - columnFill);
+            auto range = juce::Range<float>();
+
+            for(int c = 0; c < numChannels; ++c)
+            {
+                const auto channelRange = juce::FloatVectorOperations::findMinAndMax(channels[c] + start, chunk);
+                const auto channelRangeF = juce::Range<float>(static_cast<float>(channelRange.getStart()), static_cast<float>(channelRange.getEnd()));
+                range = c == 0 ? channelRangeF : range.getUnionWith(channelRangeF);
+            }
+
+            addToColumn(range);
+            columnFill += chunk;
+            start += chunk;
+
+            if(columnFill == samplesPerColumn) {
+                nextColumn();
+            }
+        }
+    }
+
+    //==============================================================================
+    /** Reader: copies the latest complete window into dest. Returns false if nothing new was published. */
+    bool read (Columns& dest) noexcept
+    {
+        if(!snapshots.update()) {
+            return false;
+        }
+
+        dest = snapshots.getReadBuffer();
+        return true;
+    }
+
+private:
+    void addToColumn (juce::Range<float> range) noexcept
+    {
+        auto& columns = snapshots.getWriteBuffer();
+        const auto index = static_cast<size_t>(column);
+
+        if(columnFill == 0) {
+            columns.min[index] = range.getStart();
+            columns.max[index] = range.getEnd();
+        }
+        else {
+            columns.min[index] = juce::jmin(columns.min[index], range.getStart());
+            columns.max[index] = juce::jmax(columns.max[index], range.getEnd());
+        }
+    }
+
+    void nextColumn() noexcept
+    {
+        columnFill = 0;
+
+        if(++column == numColumns) {
+            column = 0;
+            snapshots.publish();
+        }
+    }
+
+    TripleBuffer<Columns> snapshots;
+    std::atomic<bool> active { false };
+
+    // audio thread only
+    bool wasActive = false;
+    int samplesPerColumn = 1, column = 0, columnFill = 0;
+};
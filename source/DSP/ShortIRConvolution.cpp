@@ -0,0 +1,213 @@
+#include "ShortIRConvolution.h"
+
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::prepare (const juce::dsp::ProcessSpec& spec, const SampleType* impulse, int numTaps)
+{
+    jassert (spec.numChannels > 0);
+    jassert (numTaps > 0);
+
+    impulseLength = numTaps;
+    const auto numChannels = static_cast<int>(spec.numChannels);
+
+    numHeadTaps = impulseLength <= maxDirectLength ? impulseLength : headLength;
+    head.assign(impulse, impulse + numHeadTaps);
+
+    historySize = numHeadTaps - 1 + static_cast<int>(spec.maximumBlockSize);
+    history.assign(static_cast<size_t>(numChannels * historySize), static_cast<SampleType>(0.0));
+
+    // segment i runs at headLength * 2^i and starts where the previous one ended. The first one covers
+    // three blocks and the others two, so every start is a multiple of the block size and at least one block in.
+    segments.clear();
+    int start = numHeadTaps, blockSize = headLength;
+    while(start < impulseLength)
+    {
+        const auto numBlocks = blockSize == maxBlockSize ? (impulseLength - start + blockSize - 1) / blockSize
+                                                         : (start == headLength ? 3 : 2);
+        const auto segmentTaps = juce::jmin(numBlocks * blockSize, impulseLength - start);
+
+        segments.emplace_back().prepare(impulse + start, segmentTaps, blockSize, start / blockSize - 1, numChannels);
+
+        start += numBlocks * blockSize;
+        blockSize = juce::jmin(blockSize * 2, maxBlockSize);
+    }
+
+    inputPointers.resize(static_cast<size_t>(numChannels));
+    outputPointers.resize(static_cast<size_t>(numChannels));
+}
+
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::reset() noexcept
+{
+    std::fill(history.begin(), history.end(), static_cast<SampleType>(0.0));
+    for(auto& s : segments) {
+        s.reset();
+    }
+}
+
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const auto numChannels = static_cast<int>(block.getNumChannels());
+    const auto numSamples  = static_cast<int>(block.getNumSamples());
+
+    jassert(numChannels <= static_cast<int>(inputPointers.size()));
+    jassert(numSamples <= historySize - (numHeadTaps - 1));
+
+    for(int c = 0; c < numChannels; ++c)
+    {
+        auto* past = history.data() + c * historySize;
+        auto* input = past + numHeadTaps - 1;
+        auto* output = block.getChannelPointer(static_cast<size_t>(c));
+
+        juce::FloatVectorOperations::copy(input, output, numSamples);
+
+        // one vectorised multiply-add over the block per tap
+        juce::FloatVectorOperations::multiply(output, input, head[0], numSamples);
+        for(int k = 1; k < numHeadTaps; ++k) {
+            juce::FloatVectorOperations::addWithMultiply(output, input - k, head[static_cast<size_t>(k)], numSamples);
+        }
+
+        inputPointers[static_cast<size_t>(c)] = input;
+        outputPointers[static_cast<size_t>(c)] = output;
+    }
+
+    for(auto& s : segments) {
+        s.process(inputPointers.data(), outputPointers.data(), numChannels, numSamples);
+    }
+
+    // keep the last numHeadTaps - 1 inputs for the next block
+    for(int c = 0; c < numChannels; ++c)
+    {
+        auto* past = history.data() + c * historySize;
+        std::copy(past + numSamples, past + numSamples + numHeadTaps - 1, past);
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::Segment::prepare (const SampleType* taps, int numTaps, int blockSizeToUse, int delayPartitionsToUse, int numChannels)
+{
+    jassert(juce::isPowerOfTwo(blockSizeToUse));
+    jassert(delayPartitionsToUse >= 0);
+
+    blockSize = blockSizeToUse;
+    numBins = blockSize + 1;
+    numPartitions = (numTaps + blockSize - 1) / blockSize;
+    delayPartitions = delayPartitionsToUse;
+    numSlots = numPartitions + delayPartitions;
+
+    const auto fftSize = 2 * blockSize;
+    fft = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(fftSize)));
+    fftBuffer.assign(static_cast<size_t>(2 * fftSize), 0.0f);
+
+    irSpectra.assign(static_cast<size_t>(numPartitions * numBins), {});
+    for(int p = 0; p < numPartitions; ++p)
+    {
+        std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+        const auto count = juce::jmin(blockSize, numTaps - p * blockSize);
+        std::copy(taps + p * blockSize, taps + p * blockSize + count, fftBuffer.begin());
+
+        fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+        const auto* bins = reinterpret_cast<const Complex*>(fftBuffer.data());
+        std::copy(bins, bins + numBins, irSpectra.begin() + p * numBins);
+    }
+
+    spectra.assign(static_cast<size_t>(numChannels * numSlots * numBins), {});
+    accumulator.assign(static_cast<size_t>(numBins), {});
+    inputs.assign(static_cast<size_t>(numChannels * 2 * blockSize), 0.0f);
+    outputs.assign(static_cast<size_t>(numChannels * blockSize), 0.0f);
+
+    reset();
+}
+
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::Segment::reset() noexcept
+{
+    std::fill(spectra.begin(), spectra.end(), Complex{});
+    std::fill(inputs.begin(), inputs.end(), 0.0f);
+    std::fill(outputs.begin(), outputs.end(), 0.0f);
+    fill = 0;
+    slot = 0;
+}
+
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::Segment::process (const SampleType* const* in, SampleType* const* out, int numChannels, int numSamples) noexcept
+{
+    int done = 0;
+    while(done < numSamples)
+    {
+        const auto count = juce::jmin(numSamples - done, blockSize - fill);
+
+        for(int c = 0; c < numChannels; ++c)
+        {
+            auto* segmentInput = inputs.data() + (c * 2 + 1) * blockSize + fill;
+            const auto* segmentOutput = outputs.data() + c * blockSize + fill;
+
+            if constexpr (std::is_same_v<SampleType, float>)
+            {
+                juce::FloatVectorOperations::copy(segmentInput, in[c] + done, count);
+                juce::FloatVectorOperations::add(out[c] + done, segmentOutput, count);
+            }
+            else
+            {
+                std::copy(in[c] + done, in[c] + done + count, segmentInput);
+                for(int i = 0; i < count; ++i) {
+                    out[c][done + i] += static_cast<SampleType>(segmentOutput[i]);
+                }
+            }
+        }
+
+        fill += count;
+        done += count;
+
+        if(fill == blockSize)
+        {
+            for(int c = 0; c < numChannels; ++c) {
+                transformBlock(c);
+            }
+            slot = (slot + 1) % numSlots;
+            fill = 0;
+        }
+    }
+}
+
+template <typename SampleType>
+void ShortIRConvolution<SampleType>::Segment::transformBlock (int channel) noexcept
+{
+    auto* frame = inputs.data() + channel * 2 * blockSize;
+    auto* channelSpectra = spectra.data() + channel * numSlots * numBins;
+
+    // spectrum of the last two blocks of input goes into this slot of the delay line
+    std::copy(frame, frame + 2 * blockSize, fftBuffer.begin());
+    std::fill(fftBuffer.begin() + 2 * blockSize, fftBuffer.end(), 0.0f);
+    fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+    const auto* bins = reinterpret_cast<const Complex*>(fftBuffer.data());
+    std::copy(bins, bins + numBins, channelSpectra + slot * numBins);
+
+    std::fill(accumulator.begin(), accumulator.end(), Complex{});
+    for(int p = 0; p < numPartitions; ++p)
+    {
+        const auto inputSlot = (slot - p - delayPartitions + 2 * numSlots) % numSlots;
+        const auto* x = channelSpectra + inputSlot * numBins;
+        const auto* h = irSpectra.data() + p * numBins;
+
+        for(int b = 0; b < numBins; ++b) {
+            accumulator[static_cast<size_t>(b)] += h[b] * x[b];
+        }
+    }
+
+    std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+    std::copy(accumulator.begin(), accumulator.end(), reinterpret_cast<Complex*>(fftBuffer.data()));
+    fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+    // overlap-save: the second half is the valid part, played out over the next block
+    std::copy(fftBuffer.begin() + blockSize, fftBuffer.begin() + 2 * blockSize, outputs.begin() + channel * blockSize);
+    std::copy(frame + blockSize, frame + 2 * blockSize, frame);
+}
+
+//==============================================================================
+template class ShortIRConvolution<float>;
+template class ShortIRConvolution<double>;
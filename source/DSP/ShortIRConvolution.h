@@ -0,0 +1,77 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include <complex>
+
+/** Zero latency convolution with a mono impulse response, applied to every channel, tuned for short cabinet IRs.
+
+    The first taps (the head) run as a time-domain FIR using the vectorised juce::FloatVectorOperations.
+    If the impulse response is longer than maxDirectLength, the rest is split into segments of
+    uniformly partitioned FFT convolution whose block size doubles along the response, each one
+    starting late enough to hide its own block of latency. Which engine runs is picked from the
+    impulse response length when it is loaded, so short IRs never pay for an FFT.
+
+    juce::dsp::FFT only works in float, so the segments transform in float for both sample types.
+    They only carry the late, much quieter part of the response; the head runs at full precision.
+*/
+template <typename SampleType>
+class ShortIRConvolution
+{
+public:
+    ShortIRConvolution() = default;
+
+    //==============================================================================
+    /** Taps at or below this length run entirely as a time-domain FIR. */
+    static constexpr int maxDirectLength = 256;
+
+    /** FIR length in front of the FFT segments, and the block size of the first segment. */
+    static constexpr int headLength = 128;
+
+    /** Largest FFT segment block size. */
+    static constexpr int maxBlockSize = 4096;
+
+    //==============================================================================
+    /** Builds the engine for the impulse response. Allocates, so call from prepare(). */
+    void prepare (const juce::dsp::ProcessSpec& spec, const SampleType* impulse, int numTaps);
+
+    /** Clears all the history. */
+    void reset() noexcept;
+
+    /** Processes the block in place. */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+    /** Returns the length of the impulse response in samples. */
+    int getImpulseLength() const noexcept { return impulseLength; }
+
+    /** Returns true if the impulse response was long enough to need the FFT segments. */
+    bool usesPartitions() const noexcept { return !segments.empty(); }
+
+private:
+
+    /** Uniformly partitioned overlap-save convolution over one stretch of the impulse response.
+        Output is added with a latency of blockSize, which the segment's start position absorbs.
+    */
+    struct Segment
+    {
+        void prepare (const SampleType* taps, int numTaps, int blockSizeToUse, int delayPartitionsToUse, int numChannels);
+        void reset() noexcept;
+        void process (const SampleType* const* in, SampleType* const* out, int numChannels, int numSamples) noexcept;
+
+        void transformBlock (int channel) noexcept;
+
+        using Complex = std::complex<float>;
+
+        int blockSize = 0, numBins = 0, numPartitions = 0, delayPartitions = 0, numSlots = 0;
+        int fill = 0, slot = 0;
+
+        std::unique_ptr<juce::dsp::FFT> fft;
+        std::vector<Complex> irSpectra, spectra, accumulator;
+        std::vector<float> inputs, outputs, fftBuffer;
+    };
+
+    std::vector<SampleType> head, history;
+    int impulseLength = 0, numHeadTaps = 0, historySize = 0;
+
+    std::vector<Segment> segments;
+    std::vector<const SampleType*> inputPointers;
+    std::vector<SampleType*> outputPointers;
+};
@@ -0,0 +1,281 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include <complex>
+
+/** Polyphase windowed-sinc tables for working between the samples of a signal.
+
+    The kernel spans numTaps samples and is tabulated at numPhases + 1 sub-sample positions.
+    Positions in between are linearly interpolated from the two nearest phases, so any
+    fractional position can be evaluated without recomputing the sinc.
+
+    Two tables are built from the same kernel:
+    - interpolation taps, for reading a band-limited signal at a fractional position
+    - step residuals, for writing a band-limited step at a fractional position on top of an
+      output that has already jumped to its new level
+
+    The window is a Kaiser window set for a stopband attenuation, so the transition band is as narrow
+    as the tap count allows for that attenuation (see getTransitionWidth()).
+
+    A linear phase kernel is centred and costs numTaps / 2 samples of latency. A minimum phase
+    kernel (the same magnitude response, folded through the real cepstrum) starts at the
+    position it is evaluated at, so it adds no latency; with the step table this gives minBLEPs.
+*/
+template <typename SampleType>
+class SincKernel
+{
+public:
+
+    enum struct Phase
+    {
+        Linear,
+        Minimum
+    };
+
+    /** Builds the tables. The cutoff (the -6dB point, in cycles per sample, 0.5 = Nyquist) sits in the middle
+        of a transition band getTransitionWidth() wide, beyond which the response stays attenuationDB down.
+        Allocates, so call from prepare().
+    */
+    void design (int numTapsToUse, int numPhasesToUse, double cutoff, double attenuationDB, Phase phaseToUse = Phase::Linear)
+    {
+        jassert(numTapsToUse > 1 && numTapsToUse % 2 == 0);
+        jassert(numPhasesToUse > 0);
+        jassert(cutoff > 0.0 && cutoff <= 0.5);
+        jassert(attenuationDB > 21.0);
+
+        numTaps = numTapsToUse;
+        numPhases = numPhasesToUse;
+        latency = phaseToUse == Phase::Linear ? numTaps / 2 : 0;
+
+        const auto halfTaps = static_cast<double>(numTaps / 2);
+        const auto beta = getKaiserBeta(attenuationDB);
+
+        // Kaiser windowed sinc over [-numTaps / 2, numTaps / 2], sampled on a grid that lands on every
+        // phase, so the tables hold the kernel itself rather than an interpolation of it
+        const auto gridPerSample = numPhases * ((64 + numPhases - 1) / numPhases);
+        const auto gridSize = static_cast<size_t>(numTaps * gridPerSample + 1);
+        std::vector<double> kernel(gridSize, 0.0);
+
+        for(size_t g = 0; g < gridSize; ++g)
+        {
+            const auto t = static_cast<double>(g) / gridPerSample - halfTaps;
+
+            constexpr auto pi = juce::MathConstants<double>::pi;
+            const auto position = juce::jlimit(-1.0, 1.0, t / halfTaps);
+            const auto window = besselI0(beta * std::sqrt(1.0 - position * position)) / besselI0(beta);
+
+            const auto x = 2.0 * cutoff * t;
+            const auto sinc = juce::approximatelyEqual(x, 0.0) ? 1.0 : std::sin(pi * x) / (pi * x);
+
+            kernel[g] = 2.0 * cutoff * sinc * window;
+        }
+
+        if(phaseToUse == Phase::Minimum) {
+            makeMinimumPhase(kernel);
+        }
+
+        // grid index g sits at time g / gridPerSample - latency
+        auto kernelAt = [&] (double t)
+        {
+            const auto pos = (t + latency) * gridPerSample;
+            if(pos < 0.0 || pos >= static_cast<double>(gridSize - 1)) {
+                return 0.0;
+            }
+            const auto index = static_cast<size_t>(pos);
+            const auto frac = pos - static_cast<double>(index);
+            return kernel[index] + frac * (kernel[index + 1] - kernel[index]);
+        };
+
+        // running integral of the kernel, for the step table
+        std::vector<double> integral(gridSize, 0.0);
+        for(size_t g = 1; g < gridSize; ++g) {
+            integral[g] = integral[g - 1] + 0.5 * (kernel[g - 1] + kernel[g]) / gridPerSample;
+        }
+
+        const auto total = integral.back();
+        auto stepAt = [&] (double t)
+        {
+            const auto pos = juce::jlimit(0.0, static_cast<double>(gridSize - 1), (t + latency) * gridPerSample);
+            const auto index = juce::jmin(static_cast<size_t>(pos), gridSize - 2);
+            const auto frac = pos - static_cast<double>(index);
+            return (integral[index] + frac * (integral[index + 1] - integral[index])) / total;
+        };
+
+        taps.resize(static_cast<size_t>((numPhases + 1) * numTaps));
+        steps.resize(static_cast<size_t>((numPhases + 1) * (numTaps + 1)));
+
+        for(int p = 0; p <= numPhases; ++p)
+        {
+            const auto fraction = static_cast<double>(p) / numPhases;
+
+            // taps are normalised so every phase has unity gain at DC
+            auto* phaseTaps = taps.data() + p * numTaps;
+            auto sum = 0.0;
+            for(int k = 0; k < numTaps; ++k) {
+                sum += kernelAt(numTaps - 1 - k + fraction - latency);
+            }
+            for(int k = 0; k < numTaps; ++k) {
+                phaseTaps[k] = static_cast<SampleType>(kernelAt(numTaps - 1 - k + fraction - latency) / sum);
+            }
+
+            auto* phaseSteps = steps.data() + p * (numTaps + 1);
+            for(int k = 0; k <= numTaps; ++k) {
+                phaseSteps[k] = static_cast<SampleType>(stepAt(k - fraction - latency) - 1.0);
+            }
+        }
+    }
+
+    int getNumTaps() const noexcept { return numTaps; }
+
+    /** Width of the transition band, in cycles per sample, of a kernel numTaps long designed for attenuationDB
+        (Kaiser's estimate). A stopband that has to start at f needs a cutoff of f minus half of this.
+    */
+    static constexpr double getTransitionWidth (int numTaps, double attenuationDB) noexcept
+    {
+        return (attenuationDB - 7.95) / (14.36 * static_cast<double>(numTaps));
+    }
+
+    /** Returns the delay added by the kernel, in samples. */
+    int getLatency() const noexcept { return latency; }
+
+    /** Fills dest (numTaps values) with the taps that read a signal at the given fraction (0-1) of a sample.
+        Applied to samples [n - numTaps + 1, n], they return the signal at n + fraction - getLatency().
+    */
+    void getInterpolationTaps (double fraction, SampleType* dest) const noexcept
+    {
+        interpolatePhases(taps.data(), numTaps, fraction, dest);
+    }
+
+    /** Fills dest (numTaps + 1 values) with the residual of a unit step placed at the given fraction (0-1) of sample n.
+        Added to output samples [n, n + numTaps] of a signal that already holds the new level from sample n,
+        it turns the jump into a band-limited step at n + fraction + getLatency().
+    */
+    void getStepResidual (double fraction, SampleType* dest) const noexcept
+    {
+        interpolatePhases(steps.data(), numTaps + 1, fraction, dest);
+    }
+
+private:
+
+    void interpolatePhases (const SampleType* table, int length, double fraction, SampleType* dest) const noexcept
+    {
+        jassert(fraction >= 0.0 && fraction <= 1.0);
+
+        const auto position = juce::jlimit(0.0, static_cast<double>(numPhases), fraction * numPhases);
+        const auto phase = juce::jmin(static_cast<int>(position), numPhases - 1);
+        const auto alpha = static_cast<SampleType>(position - phase);
+
+        const auto* a = table + phase * length;
+        const auto* b = a + length;
+
+        for(int k = 0; k < length; ++k) {
+            dest[k] = a[k] + alpha * (b[k] - a[k]);
+        }
+    }
+
+    static double getKaiserBeta (double attenuationDB) noexcept
+    {
+        if(attenuationDB > 50.0) {
+            return 0.1102 * (attenuationDB - 8.7);
+        }
+        return 0.5842 * std::pow(attenuationDB - 21.0, 0.4) + 0.07886 * (attenuationDB - 21.0);
+    }
+
+    /** Modified Bessel function of the first kind, order 0, from its power series. */
+    static double besselI0 (double x) noexcept
+    {
+        auto sum = 1.0, term = 1.0;
+        for(int k = 1; k < 64 && term > sum * 1.0e-17; ++k)
+        {
+            const auto factor = x / (2.0 * k);
+            term *= factor * factor;
+            sum += term;
+        }
+        return sum;
+    }
+
+    /** Replaces the kernel with the minimum phase filter of the same magnitude (homomorphic method). */
+    static void makeMinimumPhase (std::vector<double>& kernel)
+    {
+        using Complex = std::complex<double>;
+
+        // zero padding keeps the cepstrum from aliasing back onto itself
+        const auto size = static_cast<size_t>(juce::nextPowerOfTwo(static_cast<int>(kernel.size())) * 4);
+        std::vector<Complex> bins(size, Complex{});
+        std::copy(kernel.begin(), kernel.end(), bins.begin());
+
+        transform(bins, false);
+        for(auto& b : bins) {
+            b = Complex{ std::log(juce::jmax(std::abs(b), 1.0e-9)), 0.0 };
+        }
+        transform(bins, true);
+
+        // fold the anti-causal half of the cepstrum onto the causal half
+        for(size_t i = 1; i < size / 2; ++i) {
+            bins[i] = 2.0 * bins[i].real();
+        }
+        for(size_t i = size / 2 + 1; i < size; ++i) {
+            bins[i] = 0.0;
+        }
+        bins[0] = bins[0].real();
+        bins[size / 2] = bins[size / 2].real();
+
+        transform(bins, false);
+        for(auto& b : bins) {
+            b = std::exp(b);
+        }
+        transform(bins, true);
+
+        for(size_t i = 0; i < kernel.size(); ++i) {
+            kernel[i] = bins[i].real();
+        }
+    }
+
+    /** In-place radix-2 FFT, scaled by 1 / size on the inverse. Only used at design time. */
+    static void transform (std::vector<std::complex<double>>& data, bool inverse)
+    {
+        const auto size = data.size();
+        jassert(juce::isPowerOfTwo(size));
+
+        for(size_t i = 1, j = 0; i < size; ++i)
+        {
+            auto bit = size >> 1;
+            for(; (j & bit) != 0; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+
+            if(i < j) {
+                std::swap(data[i], data[j]);
+            }
+        }
+
+        for(size_t length = 2; length <= size; length <<= 1)
+        {
+            const auto angle = (inverse ? 2.0 : -2.0) * juce::MathConstants<double>::pi / static_cast<double>(length);
+            const auto step = std::polar(1.0, angle);
+
+            for(size_t start = 0; start < size; start += length)
+            {
+                std::complex<double> w { 1.0, 0.0 };
+                for(size_t k = 0; k < length / 2; ++k)
+                {
+                    const auto even = data[start + k];
+                    const auto odd = data[start + k + length / 2] * w;
+                    data[start + k] = even + odd;
+                    data[start + k + length / 2] = even - odd;
+                    w *= step;
+                }
+            }
+        }
+
+        if(inverse)
+        {
+            for(auto& d : data) {
+                d /= static_cast<double>(size);
+            }
+        }
+    }
+
+    int numTaps = 0, numPhases = 0, latency = 0;
+    std::vector<SampleType> taps, steps;
+};
@@ -0,0 +1,113 @@
+#include "SoftClipper.h"
+
+template <typename SampleType>
+void SoftClipper<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.numChannels > 0);
+
+    lastInput.resize(spec.numChannels);
+    reset();
+}
+
+template <typename SampleType>
+void SoftClipper<SampleType>::reset() noexcept
+{
+    std::fill(lastInput.begin(), lastInput.end(), static_cast<SampleType>(0.0));
+}
+
+template <typename SampleType>
+typename SoftClipper<SampleType>::SIMDType SoftClipper<SampleType>::curve (SIMDType x) noexcept
+{
+    const auto one = SIMDType::expand(static_cast<SampleType>(1.0));
+    x = SIMDType::max(SIMDType::expand(static_cast<SampleType>(-1.0)), SIMDType::min(one, x));
+
+    return x * (SIMDType::expand(static_cast<SampleType>(1.5)) - SIMDType::expand(static_cast<SampleType>(0.5)) * x * x);
+}
+
+template <typename SampleType>
+typename SoftClipper<SampleType>::SIMDType SoftClipper<SampleType>::antiderivativeDifference (SIMDType x, SIMDType x1) noexcept
+{
+    // F is G(c) = 0.75c^2 - 0.125c^4 on the clipped input c, plus the excess |x| - |c| beyond +-1.
+    // G(c) - G(c1) factors into (c + c1)(0.75 - 0.125(c^2 + c1^2))(c - c1), and the excesses are
+    // small and exact, so every term is a product of differences and nothing large cancels
+    const auto one = SIMDType::expand(static_cast<SampleType>(1.0));
+    const auto minusOne = SIMDType::expand(static_cast<SampleType>(-1.0));
+    const auto c  = SIMDType::max(minusOne, SIMDType::min(one, x));
+    const auto c1 = SIMDType::max(minusOne, SIMDType::min(one, x1));
+
+    const auto sum = c + c1;
+    const auto slope = sum * (SIMDType::expand(static_cast<SampleType>(0.75)) - SIMDType::expand(static_cast<SampleType>(0.125)) * (c * c + c1 * c1));
+
+    return slope * (c - c1) + SIMDType::abs(x - c) - SIMDType::abs(x1 - c1);
+}
+
+template <typename SampleType>
+void SoftClipper<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples  = block.getNumSamples();
+
+    jassert(numChannels <= lastInput.size());
+
+    if(context.isBypassed) {
+        return;
+    }
+
+    const auto one = SIMDType::expand(static_cast<SampleType>(1.0));
+    const auto half = SIMDType::expand(static_cast<SampleType>(0.5));
+    const auto minDelta = SIMDType::expand(tolerance);
+
+    alignas(SIMDType::SIMDRegisterSize) SampleType current[laneWidth];
+    alignas(SIMDType::SIMDRegisterSize) SampleType previous[laneWidth];
+    alignas(SIMDType::SIMDRegisterSize) SampleType numerator[laneWidth];
+    alignas(SIMDType::SIMDRegisterSize) SampleType denominator[laneWidth];
+    alignas(SIMDType::SIMDRegisterSize) SampleType result[laneWidth];
+
+    for(size_t channel = 0; channel < numChannels; ++channel)
+    {
+        auto* data = block.getChannelPointer(channel);
+        auto last = lastInput[channel];
+
+        for(size_t start = 0; start < numSamples; start += laneWidth)
+        {
+            const auto count = juce::jmin(laneWidth, numSamples - start);
+
+            // the tail of a block repeats its last sample in the unused lanes
+            for(size_t l = 0; l < laneWidth; ++l)
+            {
+                previous[l] = l == 0 ? last : current[l - 1];
+                current[l] = data[start + juce::jmin(l, count - 1)];
+            }
+
+            const auto x  = SIMDType::fromRawArray(current);
+            const auto x1 = SIMDType::fromRawArray(previous);
+
+            const auto delta = x - x1;
+            const auto useMidpoint = SIMDType::lessThan(SIMDType::abs(delta), minDelta);
+
+            // the difference is swapped for 1 in lanes that fall back to the midpoint, so nothing divides by 0.
+            // Lanes that divide add exactly 0, so the (tiny) difference itself isn't rounded.
+            // SIMDRegister has no division, the compiler vectorises the lane loop instead
+            antiderivativeDifference(x, x1).copyToRawArray(numerator);
+            (delta + ((one - delta) & useMidpoint)).copyToRawArray(denominator);
+            for(size_t l = 0; l < laneWidth; ++l) {
+                numerator[l] /= denominator[l];
+            }
+
+            const auto quotient = SIMDType::fromRawArray(numerator);
+            const auto midpoint = curve((x + x1) * half);
+
+            (quotient + ((midpoint - quotient) & useMidpoint)).copyToRawArray(result);
+
+            std::copy(result, result + count, data + start);
+            last = current[count - 1];
+        }
+
+        lastInput[channel] = last;
+    }
+}
+
+//==============================================================================
+template class SoftClipper<float>;
+template class SoftClipper<double>;
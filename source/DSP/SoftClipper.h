@@ -0,0 +1,51 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+
+/** Cubic soft clipper with first order antiderivative anti-aliasing (ADAA).
+
+    The curve is 1.5x - 0.5x^3 inside [-1, 1] and hard limits at +-1 outside it. Instead of the curve
+    itself, each output is the mean of the curve between the previous and the current input (the
+    difference of the antiderivative divided by the difference of the inputs). That low-passes the
+    harmonics the clipper creates, so it stays clean at the host rate.
+
+    The difference of the antiderivative is worked out in closed form rather than by subtracting two
+    evaluations, which would cancel to noise in float once consecutive inputs are close.
+
+    The averaging delays the output by half a sample. The dry path is only delayed by whole samples,
+    so while the mixer fades between them (switching the effect on or off) the two are half a sample
+    apart, a gentle comb at the top of the spectrum for the length of the fade.
+
+    Samples are processed laneWidth at a time in SIMD registers, all branch free.
+*/
+template <typename SampleType>
+class SoftClipper
+{
+public:
+    SoftClipper() = default;
+
+    //==============================================================================
+    /** Initialises the processor. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /** Resets the internal state variables of the processor. */
+    void reset() noexcept;
+
+    /** Processes the block in place. */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+    static constexpr size_t laneWidth = SIMDType::SIMDNumElements;
+
+    static SIMDType curve (SIMDType x) noexcept;
+
+    /** F(x) - F(x1) for the antiderivative F, without cancellation. */
+    static SIMDType antiderivativeDifference (SIMDType x, SIMDType x1) noexcept;
+
+    // the difference stays accurate however close the inputs are, only repeated inputs (or ones flushed
+    // to zero) fall back to the curve itself
+    static constexpr SampleType tolerance = std::numeric_limits<SampleType>::min();
+
+    std::vector<SampleType> lastInput;
+};
@@ -0,0 +1,188 @@
+#include "SpeakerBank.h"
+#include <juce_audio_formats/juce_audio_formats.h>
+
+template <typename SampleType>
+void SpeakerBank<SampleType>::addImpulseResponse (const void* sourceData, size_t sourceDataSize)
+{
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor(std::make_unique<juce::MemoryInputStream>(sourceData, sourceDataSize, false)));
+    jassert(reader != nullptr);
+
+    if(reader == nullptr) {
+        return;
+    }
+
+    auto& ir = impulseResponses.emplace_back();
+    ir.sampleRate = reader->sampleRate;
+    ir.samples.setSize(1, static_cast<int>(reader->lengthInSamples));
+    reader->read(&ir.samples, 0, ir.samples.getNumSamples(), 0, true, false);
+}
+
+template <typename SampleType>
+std::vector<SampleType> SpeakerBank<SampleType>::resample (const ImpulseResponse& ir, double newSampleRate)
+{
+    const auto* original = ir.samples.getReadPointer(0);
+
+    if(juce::approximatelyEqual(ir.sampleRate, newSampleRate)) {
+        return std::vector<SampleType>(original, original + ir.samples.getNumSamples());
+    }
+
+    const auto ratio = ir.sampleRate / newSampleRate;
+
+    auto source = ir.samples;
+    juce::MemoryAudioSource memorySource (source, false);
+    juce::ResamplingAudioSource resamplingSource (&memorySource, false, 1);
+
+    const auto newLength = juce::roundToInt(juce::jmax(1.0, ir.samples.getNumSamples() / ratio));
+    resamplingSource.setResamplingRatio(ratio);
+    resamplingSource.prepareToPlay(newLength, ir.sampleRate);
+
+    juce::AudioBuffer<float> result (1, newLength);
+    resamplingSource.getNextAudioBlock({ &result, 0, newLength });
+
+    // same level as before: more (or fewer) taps per second of response
+    std::vector<SampleType> taps(static_cast<size_t>(newLength));
+    for(int i = 0; i < newLength; ++i) {
+        taps[static_cast<size_t>(i)] = static_cast<SampleType>(result.getSample(0, i) * ratio);
+    }
+    return taps;
+}
+
+template <typename SampleType>
+void SpeakerBank<SampleType>::prepare (const juce::dsp::ProcessSpec& spec)
+{
+    jassert (spec.sampleRate > 0);
+    jassert (spec.numChannels > 0);
+
+    const auto numChannels = static_cast<int>(spec.numChannels);
+
+    engines.resize(impulseResponses.size());
+    clippers.resize(impulseResponses.size());
+    for(size_t i = 0; i < impulseResponses.size(); ++i)
+    {
+        const auto taps = resample(impulseResponses[i], spec.sampleRate);
+        engines[i].prepare(spec, taps.data(), static_cast<int>(taps.size()));
+        clippers[i].prepare(spec);
+    }
+
+    fadeBuffer.setSize(numChannels, static_cast<int>(spec.maximumBlockSize));
+    fadeLength = juce::jmax(1, juce::roundToInt(spec.sampleRate * crossfadeTime));
+
+    // the next setSpeaker() call selects without fading
+    currentSpeaker = -1;
+    reset();
+}
+
+template <typename SampleType>
+int SpeakerBank<SampleType>::getTailLengthInSamples() const noexcept
+{
+    int length = 0;
+    for(const auto& engine : engines) {
+        length = juce::jmax(length, engine.getImpulseLength());
+    }
+    return length;
+}
+
+template <typename SampleType>
+void SpeakerBank<SampleType>::reset() noexcept
+{
+    for(auto& engine : engines) {
+        engine.reset();
+    }
+    for(auto& clipper : clippers) {
+        clipper.reset();
+    }
+
+    previousSpeaker = juce::jmax(0, currentSpeaker);
+    fadeRemaining = 0;
+}
+
+template <typename SampleType>
+void SpeakerBank<SampleType>::setSpeaker (int speakerIndex) noexcept
+{
+    speakerIndex = juce::jlimit(0, getNumSpeakers() - 1, speakerIndex);
+
+    if(speakerIndex == currentSpeaker) {
+        return;
+    }
+
+    if(currentSpeaker < 0) {
+        currentSpeaker = speakerIndex;
+        previousSpeaker = speakerIndex;
+        return;
+    }
+
+    // the incoming engines have been idle, so clear their old history before fading them in
+    if(speakerIndex > 0) {
+        engines[static_cast<size_t>(speakerIndex - 1)].reset();
+        clippers[static_cast<size_t>(speakerIndex - 1)].reset();
+    }
+
+    previousSpeaker = currentSpeaker;
+    currentSpeaker = speakerIndex;
+    fadeRemaining = fadeLength;
+}
+
+template <typename SampleType>
+void SpeakerBank<SampleType>::process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples  = block.getNumSamples();
+
+    if(context.isBypassed) {
+        return;
+    }
+
+    const auto speaker = juce::jmax(0, currentSpeaker);
+
+    if(fadeRemaining == 0) {
+        processSpeaker(speaker, block);
+        return;
+    }
+
+    jassert(numSamples <= static_cast<size_t>(fadeBuffer.getNumSamples()));
+
+    // outgoing speaker on a copy of the input, incoming speaker in place, then a linear crossfade
+    auto fadeBlock = juce::dsp::AudioBlock<SampleType>(fadeBuffer).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+    fadeBlock.copyFrom(block);
+
+    processSpeaker(previousSpeaker, fadeBlock);
+    processSpeaker(speaker, block);
+
+    const auto fadeStep = static_cast<SampleType>(1.0) / static_cast<SampleType>(fadeLength);
+    const auto fadeStart = static_cast<SampleType>(fadeLength - fadeRemaining) * fadeStep;
+    const auto numFadeSamples = juce::jmin(numSamples, static_cast<size_t>(fadeRemaining));
+
+    for(size_t c = 0; c < numChannels; ++c)
+    {
+        auto* out = block.getChannelPointer(c);
+        const auto* old = fadeBlock.getChannelPointer(c);
+
+        for(size_t s = 0; s < numFadeSamples; ++s)
+        {
+            const auto g = fadeStart + static_cast<SampleType>(s) * fadeStep;
+            out[s] = old[s] + g * (out[s] - old[s]);
+        }
+    }
+
+    fadeRemaining -= static_cast<int>(numFadeSamples);
+}
+
+template <typename SampleType>
+void SpeakerBank<SampleType>::processSpeaker (int speakerIndex, juce::dsp::AudioBlock<SampleType>& block) noexcept
+{
+    if(speakerIndex == 0) {
+        return;
+    }
+
+    const auto context = juce::dsp::ProcessContextReplacing<SampleType>(block);
+    engines[static_cast<size_t>(speakerIndex - 1)].process(context);
+    clippers[static_cast<size_t>(speakerIndex - 1)].process(context);
+}
+
+//==============================================================================
+template class SpeakerBank<float>;
+template class SpeakerBank<double>;
@@ -0,0 +1,69 @@
+#pragma once
+#include <juce_dsp/juce_dsp.h>
+#include "ShortIRConvolution.h"
+#include "SoftClipper.h"
+
+/** The speaker stage: a set of cabinet impulse responses, each followed by the soft clipper.
+
+    Impulse responses are decoded when added, then resampled and partitioned into their own
+    ShortIRConvolution during prepare(), so none of that happens on the audio thread. Switching
+    speaker on the audio thread only changes an index and starts a short linear crossfade between
+    the outgoing and incoming speaker. Index 0 is no speaker (the signal passes through untouched).
+*/
+template <typename SampleType>
+class SpeakerBank
+{
+public:
+    SpeakerBank() = default;
+
+    //==============================================================================
+    /** Decodes an impulse response (WAV or AIFF data, first channel only) and adds it as the next speaker index.
+        Call before prepare().
+    */
+    void addImpulseResponse (const void* sourceData, size_t sourceDataSize);
+
+    /** Selects the speaker to use (0 = none). Safe to call from the audio thread, never allocates. */
+    void setSpeaker (int speakerIndex) noexcept;
+
+    /** Returns the length of the longest impulse response in samples, as prepared. */
+    int getTailLengthInSamples() const noexcept;
+
+    /** Returns the number of speaker choices, including none. */
+    int getNumSpeakers() const noexcept { return static_cast<int>(impulseResponses.size()) + 1; }
+
+    //==============================================================================
+    /** Builds the convolution engines for every impulse response. Allocates. */
+    void prepare (const juce::dsp::ProcessSpec& spec);
+
+    /** Clears the engines and finishes any crossfade. */
+    void reset() noexcept;
+
+    /** Processes the block in place. */
+    void process (const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+
+    /** Convolution and soft clipper for one speaker, in place. Speaker 0 does nothing. */
+    void processSpeaker (int speakerIndex, juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    struct ImpulseResponse
+    {
+        juce::AudioBuffer<float> samples;
+        double sampleRate = 44100.0;
+    };
+
+    /** Returns the impulse response at the new rate, with the gain corrected for the change in length. */
+    static std::vector<SampleType> resample (const ImpulseResponse& ir, double newSampleRate);
+
+    static constexpr double crossfadeTime = 0.02;
+
+    std::vector<ImpulseResponse> impulseResponses;
+
+    // engines[speaker - 1], each speaker keeps its own clipper state so both sides of a crossfade stay continuous
+    std::vector<ShortIRConvolution<SampleType>> engines;
+    std::vector<SoftClipper<SampleType>> clippers;
+
+    juce::AudioBuffer<SampleType> fadeBuffer;
+    int currentSpeaker = -1, previousSpeaker = 0;
+    int fadeLength = 0, fadeRemaining = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <atomic>
+
+/** Hands the latest value of T from one writer thread to one reader thread, wait-free on both sides.
+
+    The writer fills getWriteBuffer() and calls publish(). The reader calls update() and then reads
+    getReadBuffer(). Neither side ever waits for the other or sees a half written value. If the
+    writer publishes several times between reads, the reader only gets the most recent one.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    //==============================================================================
+    /** Writer: the buffer to fill next. Its contents are whatever was last handed back by the reader. */
+    T& getWriteBuffer() noexcept { return buffers[static_cast<size_t>(writeIndex)]; }
+
+    /** Writer: makes the write buffer the latest value and takes a spare one to write into next. */
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | newDataBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==============================================================================
+    /** Reader: takes the latest published value if there is one. Returns true if getReadBuffer() changed. */
+    bool update() noexcept
+    {
+        if((middle.load(std::memory_order_relaxed) & newDataBit) == 0) {
+            return false;
+        }
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Reader: the value taken by the last successful update(). */
+    const T& getReadBuffer() const noexcept { return buffers[static_cast<size_t>(readIndex)]; }
+
+private:
+    static constexpr int indexMask = 3, newDataBit = 4;
+
+    std::array<T, 3> buffers {};
+    std::atomic<int> middle { 1 };
+    int writeIndex = 0, readIndex = 2;
+};
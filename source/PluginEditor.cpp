@@ -25,20 +25,17 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
     lnf.setColour(juce::DrawableButton::ColourIds::backgroundColourId, juce::Colours::transparentWhite);
     lnf.setColour(juce::DrawableButton::ColourIds::backgroundOnColourId, juce::Colours::transparentWhite);
 
-    // load background svg
+    // load background svg, it is only drawn into the static layers
     background = juce::Drawable::createFromImageData(BinaryData::Background_svg, BinaryData::Background_svgSize);
-    addAndMakeVisible(background.get());
 
-    // create labels
+    // create labels, these aren't children either, they are painted into the static layers
     for(auto& details : labelDetails)
     {
         details.shadow = std::make_unique<juce::Label>(details.text, details.text);
-        addAndMakeVisible(details.shadow.get());
         details.shadow->setJustificationType(details.justification);
         details.shadow->setColour(juce::Label::ColourIds::textColourId, juce::Colours::black.withAlpha(0.125f));
 
         details.label = std::make_unique<juce::Label>(details.text, details.text);
-        addAndMakeVisible(details.label.get());
         details.label->setJustificationType(details.justification);
     }
 
@@ -57,6 +54,7 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
     //Sample Rate
     sampleRateSlider = std::make_unique<TextSlider>();
     sampleRateSlider->setUseDigitalReadout(true);
+    sampleRateSlider->setShadowCachedByParent(true); // the "88" is part of the static layers
     addAndMakeVisible(sampleRateSlider.get());
 
     sampleRateAttachment = std::make_unique<juce::SliderParameterAttachment>(*processorRef.apvts.getParameter("sRate"), *sampleRateSlider.get());
@@ -84,9 +82,16 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
 
     powerAttachment = std::make_unique<juce::ButtonParameterAttachment>(*processorRef.apvts.getParameter("active"), *powerButton.get());
 
-    // scope
-    updateScopeDataSize();
+    // scope, the processor only reduces audio for it while an editor is open
+    jassert(scope.getDataSize() == ScopeReducer::numColumns);
     addAndMakeVisible(scope);
+    processorRef.setScopeActive(true);
+
+    // load readout
+    loadReadout.setJustificationType(juce::Justification::centred);
+    loadReadout.setColour(juce::Label::ColourIds::textColourId, mainColour.withAlpha(0.6f));
+    addAndMakeVisible(loadReadout);
+    updateLoadReadout();
 
     // resizing
     setResizable(true, true);
@@ -106,71 +111,98 @@ AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor (AudioPluginAud
 AudioPluginAudioProcessorEditor::~AudioPluginAudioProcessorEditor()
 {
     stopTimer();
+    processorRef.setScopeActive(false);
 }
 
 //==============================================================================
 
-void AudioPluginAudioProcessorEditor::updateScopeDataSize()
+void AudioPluginAudioProcessorEditor::updateLoadReadout()
 {
-    auto scopeSize = processorRef.getScopeSize();
-    if(scopeSize <= 0) {
-        return;
-    }
+    const auto average = processorRef.getAverageLoad() * 100.0f;
+    const auto peak = processorRef.getPeakLoad() * 100.0f;
+    processorRef.resetPeakLoad(); // each readout shows the peak since the previous one
 
-    scopeDataRaw.resize(scopeSize);
-    std::fill(scopeDataRaw.begin(), scopeDataRaw.end(), 0.0f);
+    loadReadout.setText("DSP " + juce::String(average, 1) + "% / " + juce::String(peak, 1) + "%", juce::dontSendNotification);
 }
 
 void AudioPluginAudioProcessorEditor::timerCallback()
 {
-    if(scopeDataRaw.empty())
-    {
-        updateScopeDataSize();
+    if(--loadReadoutCountdown <= 0) {
+        loadReadoutCountdown = loadReadoutInterval;
+        updateLoadReadout();
     }
-    else
+
+    // the processor has already reduced each window to one min/max pair per column
+    if(processorRef.readScope(scopeColumns))
     {
-        auto numSamples = processorRef.getScopeNumSamplesToRead();
-        processorRef.readScopeData(scopeDataRaw.data(), static_cast<int>(scopeDataRaw.size()));
-
-        const auto scopeSize = scope.getDataSize();
-        const auto samplesPerPixel = numSamples / scopeSize;
-        int smpCount = 0;
-        int scopeIdx = 0;
-        float max = 0.0f;
-        float min = 0.0f;
-
-        for(int i = 0; i < numSamples; ++i)
-        {
-            smpCount++;
-            
-            if(scopeDataRaw[i] > max) {
-                max = scopeDataRaw[i];
-            }
-            else if(scopeDataRaw[i] < min) {
-                min = scopeDataRaw[i];
-            }
-
-            if(smpCount >= samplesPerPixel)
-            {
-                scope.setDataAt(scopeIdx, min, max);
-                min = max = 0.0f;
-                smpCount = 0;
-                scopeIdx++;
-            }
-            if(scopeIdx >= scopeSize) {
-                break;
-            }
+        for(int i = 0; i < ScopeReducer::numColumns; ++i) {
+            scope.setDataAt(i, scopeColumns.min[static_cast<size_t>(i)], scopeColumns.max[static_cast<size_t>(i)]);
         }
 
-        scope.repaint();
+        scope.repaintChanges();
     }
 }
 
 //==============================================================================
+void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto sizeRatio = static_cast<float>(getWidth()) / originalWidthF;
+
+    if(!staticLayers.isValid() || staticLayersScale != scale || staticLayersSizeRatio != sizeRatio) {
+        renderStaticLayers(scale, sizeRatio);
+    }
+
+    if(staticLayers.isValid()) {
+        g.drawImageTransformed(staticLayers, juce::AffineTransform::scale(1.0f / staticLayersScale));
+    }
+}
+
+void AudioPluginAudioProcessorEditor::renderStaticLayers(float scale, float sizeRatio)
+{
+    const auto width = juce::roundToInt(static_cast<float>(getWidth()) * scale);
+    const auto height = juce::roundToInt(static_cast<float>(getHeight()) * scale);
+
+    if(width <= 0 || height <= 0) {
+        return;
+    }
+
+    staticLayers = juce::Image(juce::Image::ARGB, width, height, true);
+    staticLayersScale = scale;
+    staticLayersSizeRatio = sizeRatio;
+
+    juce::Graphics g(staticLayers);
+    g.addTransform(juce::AffineTransform::scale(scale));
+
+    background->drawWithin(g, getLocalBounds().toFloat(), juce::RectanglePlacement::fillDestination, 1.0f);
+
+    // components that only ever look the same are painted here at their laid out positions,
+    // clipped to their bounds the way they would be as children
+    auto paintAt = [&g] (juce::Component& component, auto&& paintFunction)
+    {
+        const juce::Graphics::ScopedSaveState state(g);
+        g.setOrigin(component.getPosition());
+        g.reduceClipRegion(component.getLocalBounds());
+        paintFunction();
+    };
+
+    for(auto& details : labelDetails)
+    {
+        paintAt(*details.shadow, [&] { details.shadow->paintEntireComponent(g, false); });
+        paintAt(*details.label, [&] { details.label->paintEntireComponent(g, false); });
+    }
+
+    for(auto* slider : { inGainSlider.get(), outGainSlider.get(), sampleRateSlider.get() })
+    {
+        if(slider->hasStaticShadow()) {
+            paintAt(*slider, [&] { slider->paintShadow(g); });
+        }
+    }
+}
+
 void AudioPluginAudioProcessorEditor::resized()
 {
     auto bounds = getLocalBounds().toFloat();
-    background->setTransformToFit(bounds, juce::RectanglePlacement::fillDestination);
     auto sizeRatio = bounds.getWidth() / originalWidthF;
 
     processorRef.setInterfaceSizeRatio(sizeRatio);
@@ -230,6 +262,12 @@ void AudioPluginAudioProcessorEditor::resized()
                            juce::roundToInt(155.0f * sizeRatio),
                            juce::roundToInt(38.0f * sizeRatio));
 
+    loadReadout.setFont(juce::Font(juce::FontOptions().withPointHeight(20.0f * sizeRatio)));
+    loadReadout.setBounds(juce::roundToInt(475.0f * sizeRatio),
+                          juce::roundToInt(395.0f * sizeRatio),
+                          juce::roundToInt(155.0f * sizeRatio),
+                          juce::roundToInt(24.0f * sizeRatio));
+
     scope.setSizeRatio(sizeRatio);
     scope.setBounds(juce::roundToInt(140.0f * sizeRatio),
                     juce::roundToInt(131.0f * sizeRatio),
@@ -15,6 +15,7 @@ public:
     ~AudioPluginAudioProcessorEditor() override;
 
     //==============================================================================
+    void paint (juce::Graphics& g) override;
     void resized() override;
 
     //==============================================================================
@@ -23,8 +24,13 @@ public:
 private:
     AudioPluginAudioProcessor& processorRef;
 
-    std::vector<float> scopeDataRaw;
-    void updateScopeDataSize();
+    AudioPluginAudioProcessor::ScopeColumns scopeColumns;
+
+    // DSP load, as average and peak percentages of real time, refreshed every few timer ticks
+    juce::Label loadReadout;
+    static constexpr int loadReadoutInterval = 6;
+    int loadReadoutCountdown = 0;
+    void updateLoadReadout();
 
     //==============================================================================
 
@@ -60,6 +66,11 @@ private:
 
     std::unique_ptr<juce::Drawable> background;
 
+    // the background, labels and static slider shadows, drawn once per size ratio and display scale
+    juce::Image staticLayers;
+    float staticLayersScale = 0.0f, staticLayersSizeRatio = 0.0f;
+    void renderStaticLayers(float scale, float sizeRatio);
+
     PixelScope scope;
 
     std::unique_ptr<TextSlider> inGainSlider, outGainSlider, sampleRateSlider;
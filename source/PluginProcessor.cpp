@@ -1,7 +1,6 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 #include <BinaryData.h>
-#include <IA_Waveshaping/BasicClippers.hpp>
 
 //==============================================================================
 AudioPluginAudioProcessor::AudioPluginAudioProcessor()
@@ -10,23 +9,63 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
        apvts(*this, nullptr, "PARAMETERS", createParameters())
 {
+    parameterHandles.active  = apvts.getRawParameterValue("active");
+    parameterHandles.inGain  = apvts.getRawParameterValue("inGain");
+    parameterHandles.outGain = apvts.getRawParameterValue("outGain");
+    parameterHandles.sRate   = apvts.getRawParameterValue("sRate");
+    parameterHandles.aaFilt  = apvts.getRawParameterValue("aaFilt");
+    parameterHandles.speaker = apvts.getRawParameterValue("speaker");
+    parameterHandles.lowLatency = apvts.getRawParameterValue("lowLatency");
+    parameterHandles.engine  = apvts.getRawParameterValue("engine");
+
+    parameterEvents.reserve(maxParameterEvents);
+
+    // CLAP events name parameters by the id the wrapper generated for them, found once here
+    for(auto* parameter : getParameters())
+    {
+        if(auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter))
+        {
+            const auto automated = getAutomatedParameter(ranged->getParameterID());
+            clapParameters.push_back({ static_cast<clap_id>(ranged->getParameterID().hashCode()), ranged, automated });
+        }
+    }
+
+    pendingHostValues = std::vector<std::atomic<float>>(clapParameters.size());
+    for(auto& value : pendingHostValues) {
+        value.store(-1.0f);
+    }
+
+    // speaker indices follow the "speaker" parameter choices, 0 being no speaker
+    auto addSpeakers = [] (auto& speaker)
+    {
+        speaker.addImpulseResponse(BinaryData::HS200_SM58_Close_wav, size_t(BinaryData::HS200_SM58_Close_wavSize));
+        speaker.addImpulseResponse(BinaryData::VL1_SM58_Edge_wav, size_t(BinaryData::VL1_SM58_Edge_wavSize));
+    };
+    addSpeakers(floatChain.speaker);
+    addSpeakers(doubleChain.speaker);
+
     apvts.addParameterListener("active", &mainControlListener);
     apvts.addParameterListener("inGain", &mainControlListener);
     apvts.addParameterListener("outGain", &mainControlListener);
 
     apvts.addParameterListener("sRate", &dpcmControlListener);
     apvts.addParameterListener("aaFilt", &dpcmControlListener);
+    apvts.addParameterListener("lowLatency", &dpcmControlListener);
 
     apvts.addParameterListener("speaker", &speakerListener);
+
+    startTimerHz(latencyReportRate);
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
 {
+    stopTimer();
     apvts.removeParameterListener("active", &mainControlListener);
     apvts.removeParameterListener("inGain", &mainControlListener);
     apvts.removeParameterListener("outGain", &mainControlListener);
     apvts.removeParameterListener("sRate", &dpcmControlListener);
     apvts.removeParameterListener("aaFilt", &dpcmControlListener);
+    apvts.removeParameterListener("lowLatency", &dpcmControlListener);
     apvts.removeParameterListener("speaker", &speakerListener);
 }
 
@@ -71,6 +110,22 @@ juce::AudioProcessorValueTreeState::ParameterLayout AudioPluginAudioProcessor::c
                 juce::StringArray{"A", "B", "C"},
                 0));
 
+    // changes the reported latency, so it is a setting rather than something to automate
+    layout.add(std::make_unique<juce::AudioParameterBool>(
+                juce::ParameterID{ "lowLatency", 1 },
+                "Low Latency",
+                false,
+                juce::AudioParameterBoolAttributes().withAutomatable(false)));
+
+    // the tick sampled engine stays at the host rate and costs a fraction of the oversampled one;
+    // switching changes the reported latency (see updateLatencySwitch()), so this is a setting as well
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+                juce::ParameterID{ "engine", 1 },
+                "Engine",
+                juce::StringArray{"Oversampled", "Tick Sampled"},
+                0,
+                juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+
     return layout;
 }
 
@@ -83,31 +138,79 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
         return;
     }
 
-    auto spec = juce::dsp::ProcessSpec{sampleRate, juce::uint32(samplesPerBlock), juce::uint32(numChannels)};
+    preparedBlockSize = static_cast<size_t>(juce::jmax(1, samplesPerBlock));
+    mixerRampSamples = juce::roundToInt(sampleRate * mixerRampTime) + samplesPerBlock;
+    wetChainIdle = false;
+    bypassFadeRemaining = 0;
 
-    smInGain.reset(sampleRate, smoothingTime);
-    smOutGain.reset(sampleRate, smoothingTime);
+    silentSamples = 0;
+    wetChainAsleep = false;
 
-    dpcm.prepare(spec);
-    speaker.prepare(spec);
+    scope.prepare(sampleRate, scopeWindow);
 
-    auto latency = dpcm.getLatencyInSamples();
-    setLatencySamples(latency);
+    loadMeter.prepare(sampleRate);
 
-    bypassDelay.prepare(spec);
-    bypassDelay.setMaximumDelayInSamples(latency + 1);
-    bypassDelay.setDelay(static_cast<float>(latency));
+    // hosts set the precision before preparing, only the chain that will run is prepared
+    if(isUsingDoublePrecision()) {
+        prepareChain(doubleChain, sampleRate, samplesPerBlock);
+    }
+    else {
+        prepareChain(floatChain, sampleRate, samplesPerBlock);
+    }
 
-    mixer.reset(nullptr);
-    mixer = std::make_unique<juce::dsp::DryWetMixer<float>>(latency + 1);
-    mixer->prepare(spec);
-    mixer->setWetLatency(static_cast<float>(latency));
+    prepared = true;
+}
 
-    scopeData.setSize(juce::roundToInt(sampleRate * scopeSize));
+template <typename SampleType>
+void AudioPluginAudioProcessor::prepareChain (ProcessingChain<SampleType>& chain, double sampleRate, int samplesPerBlock)
+{
+    const auto numChannels = getTotalNumInputChannels();
+    auto spec = juce::dsp::ProcessSpec{sampleRate, juce::uint32(samplesPerBlock), juce::uint32(numChannels)};
 
-    prepared = true;
+    chain.smOutGain.reset(sampleRate, smoothingTime);
+    chain.outGainRamp.resize(static_cast<size_t>(samplesPerBlock));
+
+    // the filter tier (and with it the reported latency) follows the render mode. Not every host re-prepares
+    // when a bounce starts or stops (AU offline rendering and CLAP don't have to), so later changes of
+    // setNonRealtime() are picked up by updateLatencySwitch() instead.
+    // Low latency monitoring only applies while playing in realtime, bounces always get the full filters.
+    offlineActive = renderingOffline.load();
+    lowLatencyRequested = parameterHandles.lowLatency->load() > 0.5f;
+    lowLatencyActive = lowLatencyRequested && !offlineActive;
+    chain.dpcm.setQuality(offlineActive ? DeltaModulation<SampleType>::Quality::Offline
+                                        : DeltaModulation<SampleType>::Quality::Realtime);
+    chain.dpcm.setLowLatency(lowLatencyActive);
+    chain.dpcm.setEngine(getSelectedEngine<SampleType>());
+    chain.dpcm.prepare(spec); // builds both engines, so updateLatencySwitch() can switch between them
+    chain.speaker.prepare(spec); // every impulse response is loaded here, switching later is click-free and allocation-free
+
+    // the delay lines are sized for any engine's latency, so switching later doesn't allocate
+    const auto maxLatency = chain.dpcm.getMaximumLatencyInSamples();
+
+    chain.dryDelay.prepare(spec);
+    chain.dryDelay.setMaximumDelayInSamples(maxLatency + 1);
+
+    chain.mixer.reset(nullptr);
+    chain.mixer = std::make_unique<juce::dsp::DryWetMixer<SampleType>>(maxLatency + 1);
+    chain.mixer->prepare(spec);
+
+    chain.latencySwitchGain.reset(sampleRate, latencySwitchTime);
+    chain.latencySwitchGain.setCurrentAndTargetValue(static_cast<SampleType>(1.0));
+    chain.dryAlignment.reset(sampleRate, latencySwitchTime);
+    chain.dryAlignment.setCurrentAndTargetValue(static_cast<SampleType>(1.0));
+    chain.latencySwitchRamp.resize(preparedBlockSize);
+    chain.dryAlignmentRamp.resize(preparedBlockSize);
+    chain.alignedDry.setSize(numChannels, static_cast<int>(preparedBlockSize));
+
+    updateLatency(chain);
+    reportLatency(); // prepareToPlay() isn't on the audio thread, the host can hear about it straight away
+    updateAllParameters(chain);
+}
 
-    updateAllParameters();
+void AudioPluginAudioProcessor::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime(isNonRealtime);
+    renderingOffline.store(isNonRealtime);
 }
 
 void AudioPluginAudioProcessor::releaseResources()
@@ -116,33 +219,61 @@ void AudioPluginAudioProcessor::releaseResources()
 
 bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    //support for mono->mono, stereo->stereo, and mono->stereo
+    //support for any layout up to maxNumChannels (in == out), and mono in to any output (but not to none)
+    const auto numIns  = layouts.getMainInputChannels();
+    const auto numOuts = layouts.getMainOutputChannels();
+
     return !layouts.getMainInputChannelSet().isDisabled()
-        && layouts.getMainInputChannels() < 3
-        && layouts.getMainOutputChannels() < 3
-        && layouts.getMainInputChannels() <= layouts.getMainOutputChannels();
+        && numOuts <= maxNumChannels
+        && numOuts >= numIns
+        && (numIns == numOuts || numIns == 1);
 }
 
 void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
                                               juce::MidiBuffer& midiMessages)
 {
-    if(!prepared || mixer == nullptr) {
+    juce::ignoreUnused (midiMessages);
+    const LoadMeter::ScopedMeasurement measurement(loadMeter, buffer.getNumSamples());
+    processChain(buffer, floatChain);
+}
+
+void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    const LoadMeter::ScopedMeasurement measurement(loadMeter, buffer.getNumSamples());
+    processChain(buffer, doubleChain);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::processChain (juce::AudioBuffer<SampleType>& buffer, ProcessingChain<SampleType>& chain)
+{
+    if(!prepared || chain.mixer == nullptr) {
+        clearParameterEvents();
         return;
     }
 
-    if(mainControlListener.checkForChanges()) {
-        updateMainParameters();
+    const auto mainChanged    = mainControlListener.checkForChanges();
+    const auto dpcmChanged    = dpcmControlListener.checkForChanges();
+    const auto speakerChanged = speakerListener.checkForChanges();
+
+    if(mainChanged || dpcmChanged || speakerChanged) {
+        readParameterSnapshot();
     }
 
-    if(dpcmControlListener.checkForChanges()) {
-        updateDPCMParameters();
+    if(mainChanged) {
+        updateMainParameters(chain);
     }
 
-    if(speakerListener.checkForChanges()) {
-        updateSpeakerParameters();
+    if(dpcmChanged) {
+        updateDPCMParameters(chain);
     }
 
-    juce::ignoreUnused (midiMessages);
+    if(speakerChanged) {
+        updateSpeakerParameters(chain);
+    }
+
+    updateLatencySwitch(chain);
 
     juce::ScopedNoDenormals noDenormals;
     const auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -152,40 +283,104 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, totalNumInputChannels);
-    auto context = juce::dsp::ProcessContextReplacing<float>(block);
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, totalNumInputChannels);
 
-    mixer->pushDrySamples(block);
-    smInGain.applyGain(buffer, numSamples);
+    // without queued events the whole block is one section, otherwise it is split at each event
+    size_t sectionStart = 0;
+    for(const auto& event : parameterEvents)
+    {
+        const auto eventPosition = static_cast<size_t>(juce::jlimit(0, numSamples, event.sampleOffset));
+        if(eventPosition > sectionStart) {
+            processSection(block.getSubBlock(sectionStart, eventPosition - sectionStart), chain);
+            sectionStart = eventPosition;
+        }
+        applyParameterEvent(event, chain);
+    }
+    clearParameterEvents();
 
-    dpcm.process(context);
+    if(sectionStart < static_cast<size_t>(numSamples)) {
+        processSection(block.getSubBlock(sectionStart), chain);
+    }
 
-    if(speakerActive)
+    for(auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
+        buffer.copyFrom(i, 0, buffer, 0, 0, numSamples);
+    }
+
+    if(!effectActive) {
+        scope.process<SampleType>(nullptr, 0, numSamples);
+    }
+    else {
+        scope.process(buffer.getArrayOfReadPointers(), totalNumInputChannels, numSamples);
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::processSection (juce::dsp::AudioBlock<SampleType> block, ProcessingChain<SampleType>& chain)
+{
+    // hosts occasionally pass more than they prepared for, every buffer in the chain is sized for preparedBlockSize
+    if(block.getNumSamples() > preparedBlockSize)
     {
-        speaker.process(context);
-        for(int c = 0; c < totalNumInputChannels; ++c)
-        {
-            auto data = block.getChannelPointer(c);
-            for(int s = 0; s < numSamples; ++s)
-            {
-                data[s] = IADSP::BasicClippers::cubicSoftClip(data[s]);
-            }
+        for(size_t start = 0; start < block.getNumSamples(); start += preparedBlockSize) {
+            processSection(block.getSubBlock(start, juce::jmin(preparedBlockSize, block.getNumSamples() - start)), chain);
         }
+        return;
     }
 
-    smOutGain.applyGain(buffer, numSamples);
+    auto context = juce::dsp::ProcessContextReplacing<SampleType>(block);
+
+    const auto numSamples = static_cast<int>(block.getNumSamples());
 
-    mixer->mixWetSamples(block);
+    // asleep when every sample since the last sound above the threshold is older than the tail
+    const auto inputRange = block.findMinAndMax();
+    const auto inputIsSilent = juce::jmax(-inputRange.getStart(), inputRange.getEnd()) < static_cast<SampleType>(silenceThreshold);
+    const auto shouldSleep = inputIsSilent && silentSamples >= tailLengthSamples;
 
-    if(totalNumInputChannels < totalNumOutputChannels) {
-        buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+    silentSamples = inputIsSilent ? juce::jmin(silentSamples + numSamples, tailLengthSamples) : 0;
+
+    if(wetChainAsleep && !shouldSleep) {
+        wakeWetChain(chain);
     }
+    wetChainAsleep = shouldSleep;
+
+    // while a latency switch is running the output goes through the delayed dry, see updateLatencySwitch()
+    const auto switching = chain.latencySwitchGain.isSmoothing() || chain.dryAlignment.isSmoothing()
+                        || chain.latencySwitchGain.getTargetValue() < static_cast<SampleType>(1.0);
 
-    if(effectActive) {
-        scopeData.addToFifo(buffer, totalNumInputChannels);
+    chain.mixer->pushDrySamples(block);
+    pushAlignedDry(block, chain, switching);
+
+    // once the bypass fade has finished (or the tail has died away) only the latency compensated dry signal is needed
+    if(wetChainIdle || wetChainAsleep)
+    {
+        block.clear();
+        chain.mixer->mixWetSamples(block);
+        mixAlignedDry(block, chain, switching);
+        return;
     }
-    else {
-        scopeData.zeroFifo(numSamples);
+
+    chain.dpcm.process(context); // input gain is applied inside, together with the rest of the host rate pre-processing
+
+    chain.speaker.process(context); // includes the soft clipper
+
+    const auto* outGains = getOutputGainRamp(chain, numSamples);
+    const auto outGain = chain.smOutGain.getCurrentValue();
+
+    for(size_t c = 0; c < block.getNumChannels(); ++c)
+    {
+        auto data = block.getChannelPointer(c);
+        for(int s = 0; s < numSamples; ++s)
+        {
+            data[s] *= (outGains != nullptr ? outGains[s] : outGain);
+        }
+    }
+
+    chain.mixer->mixWetSamples(block);
+    mixAlignedDry(block, chain, switching);
+
+    if(!effectActive)
+    {
+        bypassFadeRemaining -= numSamples;
+        wetChainIdle = bypassFadeRemaining <= 0;
     }
 }
 
@@ -193,7 +388,21 @@ void AudioPluginAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>&
                                               juce::MidiBuffer& midiMessages)
 {
     juce::ignoreUnused (midiMessages);
+    const LoadMeter::ScopedMeasurement measurement(loadMeter, buffer.getNumSamples());
+    processChainBypassed(buffer, floatChain);
+}
 
+void AudioPluginAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer,
+                                              juce::MidiBuffer& midiMessages)
+{
+    juce::ignoreUnused (midiMessages);
+    const LoadMeter::ScopedMeasurement measurement(loadMeter, buffer.getNumSamples());
+    processChainBypassed(buffer, doubleChain);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::processChainBypassed (juce::AudioBuffer<SampleType>& buffer, ProcessingChain<SampleType>& chain)
+{
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
@@ -201,74 +410,389 @@ void AudioPluginAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>&
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    auto block = juce::dsp::AudioBlock<float>(buffer).getSubsetChannelBlock(0, totalNumInputChannels);
-    auto context = juce::dsp::ProcessContextReplacing<float>(block);
-    bypassDelay.process(context);
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, totalNumInputChannels);
+    auto context = juce::dsp::ProcessContextReplacing<SampleType>(block);
+    chain.dryDelay.process(context);
     
-    scopeData.zeroFifo(buffer.getNumSamples());
+    scope.process<SampleType>(nullptr, 0, buffer.getNumSamples());
+
+    // nothing to apply while bypassed, the parameters still take the host's values
+    clearParameterEvents();
 }
 
 //==============================================================================
 
-void AudioPluginAudioProcessor::updateMainParameters()
+template <typename SampleType>
+void AudioPluginAudioProcessor::updateMainParameters (ProcessingChain<SampleType>& chain)
 {
-    jassert(mixer);
+    jassert(chain.mixer);
 
-    if(mixer == nullptr) {
+    if(chain.mixer == nullptr) {
         return;
     }
 
-    effectActive = loadRawParameterValue("active") > 0.5f;
-    mixer->setWetMixProportion(effectActive ? 1.0f : 0.0f); // using mixer for bypass to avoid clicks
+    effectActive = parameters.active;
+    chain.mixer->setWetMixProportion(effectActive ? static_cast<SampleType>(1.0) : static_cast<SampleType>(0.0)); // using mixer for bypass to avoid clicks
 
-    smInGain.setTargetValue(juce::Decibels::decibelsToGain(loadRawParameterValue("inGain")));
-    smOutGain.setTargetValue(juce::Decibels::decibelsToGain(loadRawParameterValue("outGain")));
+    chain.dpcm.setInputGain(juce::Decibels::decibelsToGain(static_cast<SampleType>(parameters.inGainDB)));
+    chain.smOutGain.setTargetValue(juce::Decibels::decibelsToGain(static_cast<SampleType>(parameters.outGainDB)));
+
+    if(effectActive)
+    {
+        bypassFadeRemaining = 0;
+
+        // the wet chain restarts from clean state and fades in with the mixer, so no stale samples come out
+        if(wetChainIdle)
+        {
+            wakeWetChain(chain);
+            wetChainIdle = false;
+        }
+    }
+    else if(!wetChainIdle && bypassFadeRemaining <= 0)
+    {
+        bypassFadeRemaining = mixerRampSamples;
+    }
 }
 
-void AudioPluginAudioProcessor::updateDPCMParameters()
+template <typename SampleType>
+void AudioPluginAudioProcessor::updateDPCMParameters (ProcessingChain<SampleType>& chain)
 {
-    dpcm.setAntiAliasing(loadRawParameterValue("aaFilt") > 0.5f);
-    dpcm.setSampleRate(juce::roundToInt(loadRawParameterValue("sRate")));
+    chain.dpcm.setAntiAliasing(parameters.aaFilt);
+    chain.dpcm.setSampleRate(parameters.sRate);
+
+    // the switch itself waits for the wet to fade out, see updateLatencySwitch()
+    lowLatencyRequested = parameters.lowLatency;
 }
 
-void AudioPluginAudioProcessor::updateSpeakerParameters()
+template <typename SampleType>
+void AudioPluginAudioProcessor::updateLatencySwitch (ProcessingChain<SampleType>& chain)
 {
-    auto newSpeakerChoice = juce::roundToInt(loadRawParameterValue("speaker"));
+    auto& gain = chain.latencySwitchGain;
 
-    if(speakerChoice == newSpeakerChoice) {
+    if(gain.isSmoothing() || chain.dryAlignment.isSmoothing()) {
         return;
     }
 
-    speakerChoice = newSpeakerChoice;
-    speakerActive = speakerChoice > 0;
+    const auto offlineRequested = renderingOffline.load();
+    const auto lowLatencyWanted = lowLatencyRequested && !offlineRequested;
+    const auto engineWanted = getSelectedEngine<SampleType>();
+
+    if(lowLatencyWanted != lowLatencyActive || offlineRequested != offlineActive || engineWanted != chain.dpcm.getEngine())
+    {
+        // fade the wet out to the dry first, then swap the filters while only the dry is heard and move the dry
+        // over to the new latency. The wet fades back in once that is done, by which time the new filters are full.
+        // Asleep, both the wet chain and the dry delay only hold silence, so it can swap straight away.
+        if(!wetChainAsleep && gain.getTargetValue() > static_cast<SampleType>(0.0)) {
+            gain.setTargetValue(static_cast<SampleType>(0.0));
+            return;
+        }
+
+        const auto previousLatency = chain.dpcm.getLatencyInSamples();
+
+        offlineActive = offlineRequested;
+        lowLatencyActive = lowLatencyWanted;
+        chain.dpcm.setQuality(offlineActive ? DeltaModulation<SampleType>::Quality::Offline
+                                            : DeltaModulation<SampleType>::Quality::Realtime);
+        chain.dpcm.setLowLatency(lowLatencyActive);
+        chain.dpcm.setEngine(engineWanted);
+        updateLatency(chain);
+
+        if(!wetChainAsleep && previousLatency != chain.dryDelayTo)
+        {
+            chain.dryDelayFrom = previousLatency;
+            chain.dryAlignment.setCurrentAndTargetValue(static_cast<SampleType>(0.0));
+            chain.dryAlignment.setTargetValue(static_cast<SampleType>(1.0));
+            return;
+        }
+
+        gain.setTargetValue(static_cast<SampleType>(1.0));
+    }
+    else if(gain.getTargetValue() < static_cast<SampleType>(1.0))
+    {
+        // switched back before the swap happened
+        gain.setTargetValue(static_cast<SampleType>(1.0));
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::pushAlignedDry (const juce::dsp::AudioBlock<SampleType>& block, ProcessingChain<SampleType>& chain, bool switching)
+{
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= chain.dryAlignmentRamp.size()); // processSection() splits longer blocks
+
+    if(switching) {
+        for(size_t s = 0; s < numSamples; ++s) {
+            chain.dryAlignmentRamp[s] = chain.dryAlignment.getNextValue();
+        }
+    }
 
-    if(!speakerActive) {
+    const auto from = static_cast<SampleType>(chain.dryDelayFrom);
+    const auto to   = static_cast<SampleType>(chain.dryDelayTo);
+
+    for(size_t c = 0; c < block.getNumChannels(); ++c)
+    {
+        const auto channel = static_cast<int>(c);
+        const auto* input = block.getChannelPointer(c);
+        auto* dry = chain.alignedDry.getWritePointer(channel);
+
+        for(size_t s = 0; s < numSamples; ++s)
+        {
+            chain.dryDelay.pushSample(channel, input[s]);
+
+            // the read position has to move on every sample, whether the dry is needed or not
+            if(!switching) {
+                chain.dryDelay.popSample(channel);
+                continue;
+            }
+
+            const auto previous = chain.dryDelay.popSample(channel, from, false);
+            const auto current  = chain.dryDelay.popSample(channel, to);
+            dry[s] = previous + chain.dryAlignmentRamp[s] * (current - previous);
+        }
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::mixAlignedDry (juce::dsp::AudioBlock<SampleType>& block, ProcessingChain<SampleType>& chain, bool switching)
+{
+    if(!switching) {
         return;
     }
 
-    speaker.reset();
-    
-    if(speakerChoice == 1) {
-        speaker.loadImpulseResponse(BinaryData::HS200_SM58_Close_wav, size_t(BinaryData::HS200_SM58_Close_wavSize),
-                                    juce::dsp::Convolution::Stereo::no,
-                                    juce::dsp::Convolution::Trim::no,
-                                    0,
-                                    juce::dsp::Convolution::Normalise::no);
+    const auto numSamples = block.getNumSamples();
+    for(size_t s = 0; s < numSamples; ++s) {
+        chain.latencySwitchRamp[s] = chain.latencySwitchGain.getNextValue();
     }
-    else {
-        speaker.loadImpulseResponse(BinaryData::VL1_SM58_Edge_wav, size_t(BinaryData::VL1_SM58_Edge_wavSize),
-                                    juce::dsp::Convolution::Stereo::no,
-                                    juce::dsp::Convolution::Trim::no,
-                                    0,
-                                    juce::dsp::Convolution::Normalise::no);
+
+    for(size_t c = 0; c < block.getNumChannels(); ++c)
+    {
+        auto* output = block.getChannelPointer(c);
+        const auto* dry = chain.alignedDry.getReadPointer(static_cast<int>(c));
+
+        for(size_t s = 0; s < numSamples; ++s) {
+            output[s] = dry[s] + chain.latencySwitchRamp[s] * (output[s] - dry[s]);
+        }
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::updateLatency (ProcessingChain<SampleType>& chain)
+{
+    const auto latency = chain.dpcm.getLatencyInSamples();
+    latencyToReport.store(latency);
+
+    chain.dryDelayTo = latency;
+    chain.dryDelay.setDelay(static_cast<SampleType>(latency));
+    chain.mixer->setWetLatency(static_cast<SampleType>(latency));
+
+    // everything after the DPCM adds its own ring on top of the DPCM tail
+    const auto sampleRate = getSampleRate();
+    const auto tail = chain.dpcm.getTailLengthSeconds() + chain.speaker.getTailLengthInSamples() / sampleRate;
+    tailLengthSeconds.store(tail);
+    tailLengthSamples = static_cast<int>(std::ceil(tail * sampleRate));
+}
+
+void AudioPluginAudioProcessor::reportLatency()
+{
+    const auto latency = latencyToReport.exchange(-1);
+
+    if(latency >= 0) {
+        setLatencySamples(latency); // hosts pick up the change asynchronously
+    }
+}
+
+void AudioPluginAudioProcessor::timerCallback()
+{
+    reportLatency();
+    applyHostValues();
+}
+
+template <typename SampleType>
+typename DeltaModulation<SampleType>::Engine AudioPluginAudioProcessor::getSelectedEngine() const
+{
+    return juce::roundToInt(parameterHandles.engine->load()) == 1 ? DeltaModulation<SampleType>::Engine::TickSampled
+                                                                   : DeltaModulation<SampleType>::Engine::Oversampled;
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::updateSpeakerParameters (ProcessingChain<SampleType>& chain)
+{
+    chain.speaker.setSpeaker(parameters.speaker);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::wakeWetChain (ProcessingChain<SampleType>& chain)
+{
+    chain.dpcm.reset();
+    chain.speaker.reset();
+    chain.smOutGain.setCurrentAndTargetValue(chain.smOutGain.getTargetValue());
+}
+
+template <typename SampleType>
+const SampleType* AudioPluginAudioProcessor::getOutputGainRamp (ProcessingChain<SampleType>& chain, int numSamples)
+{
+    if(!chain.smOutGain.isSmoothing()) {
+        return nullptr;
+    }
+
+    jassert(numSamples <= static_cast<int>(chain.outGainRamp.size())); // processSection() splits longer blocks
+    for(int s = 0; s < numSamples; ++s) {
+        chain.outGainRamp[static_cast<size_t>(s)] = chain.smOutGain.getNextValue();
     }
+    return chain.outGainRamp.data();
 }
 
-void AudioPluginAudioProcessor::updateAllParameters()
+void AudioPluginAudioProcessor::readParameterSnapshot()
 {
-    updateMainParameters();
-    updateDPCMParameters();
-    updateSpeakerParameters();
+    parameters.active    = parameterHandles.active->load() > 0.5f;
+    parameters.inGainDB  = parameterHandles.inGain->load();
+    parameters.outGainDB = parameterHandles.outGain->load();
+    parameters.sRate     = juce::roundToInt(parameterHandles.sRate->load());
+    parameters.aaFilt    = parameterHandles.aaFilt->load() > 0.5f;
+    parameters.speaker   = juce::roundToInt(parameterHandles.speaker->load());
+    parameters.lowLatency = parameterHandles.lowLatency->load() > 0.5f;
+
+    // host values applyHostValues() hasn't got to yet are newer than the parameters
+    for(size_t i = 0; i < clapParameters.size(); ++i)
+    {
+        const auto& clapParameter = clapParameters[i];
+        const auto value = pendingHostValues[i].load();
+
+        if(clapParameter.automated.has_value() && value >= 0.0f) {
+            setSnapshotValue(*clapParameter.automated, clapParameter.parameter->convertFrom0to1(value));
+        }
+    }
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::updateAllParameters (ProcessingChain<SampleType>& chain)
+{
+    readParameterSnapshot();
+    updateMainParameters(chain);
+    updateDPCMParameters(chain);
+    updateSpeakerParameters(chain);
+}
+
+bool AudioPluginAudioProcessor::addParameterEvent(AutomatedParameter parameter, int sampleOffset, float value)
+{
+    if(parameterEvents.size() == parameterEvents.capacity()) {
+        return false;
+    }
+
+    // kept in time order so processBlock can walk them once; events at the same offset keep their order
+    auto position = std::upper_bound(parameterEvents.begin(), parameterEvents.end(), sampleOffset,
+                                     [] (int offset, const ParameterEvent& e) { return offset < e.sampleOffset; });
+    parameterEvents.insert(position, { sampleOffset, parameter, value });
+    return true;
+}
+
+std::optional<AudioPluginAudioProcessor::AutomatedParameter> AudioPluginAudioProcessor::getAutomatedParameter(const juce::String& parameterID)
+{
+    if(parameterID == "active")  return AutomatedParameter::Active;
+    if(parameterID == "inGain")  return AutomatedParameter::InputGain;
+    if(parameterID == "outGain") return AutomatedParameter::OutputGain;
+    if(parameterID == "sRate")   return AutomatedParameter::SampleRate;
+    if(parameterID == "aaFilt")  return AutomatedParameter::AntiAliasing;
+    if(parameterID == "speaker") return AutomatedParameter::Speaker;
+    return std::nullopt; // lowLatency and engine are settings, not automatable
+}
+
+namespace
+{
+    /** What the CLAP wrapper does with a parameter event it handles itself. */
+    void setParameterFromHost(juce::AudioProcessorParameter& parameter, float normalisedValue)
+    {
+        if(parameter.getValue() != normalisedValue) {
+            parameter.setValue(normalisedValue);
+            parameter.sendValueChangedMessageToListeners(normalisedValue);
+        }
+    }
+}
+
+void AudioPluginAudioProcessor::clearParameterEvents()
+{
+    parameterEvents.clear();
+}
+
+void AudioPluginAudioProcessor::applyHostValues()
+{
+    for(size_t i = 0; i < clapParameters.size(); ++i)
+    {
+        auto& pending = pendingHostValues[i];
+        auto value = pending.load();
+
+        if(value < 0.0f) {
+            continue;
+        }
+
+        // the listeners flag these, and the next block reads back the values its events already applied.
+        // Only cleared once the parameter holds it, so readParameterSnapshot() always sees one or the other
+        setParameterFromHost(*clapParameters[i].parameter, value);
+        pending.compare_exchange_strong(value, -1.0f);
+    }
+}
+
+bool AudioPluginAudioProcessor::supportsDirectEvent(uint16_t spaceId, uint16_t type)
+{
+    return spaceId == CLAP_CORE_EVENT_SPACE_ID && type == CLAP_EVENT_PARAM_VALUE;
+}
+
+void AudioPluginAudioProcessor::handleDirectEvent(const clap_event_header_t* event, int sampleOffset)
+{
+    if(event->space_id != CLAP_CORE_EVENT_SPACE_ID || event->type != CLAP_EVENT_PARAM_VALUE) {
+        return;
+    }
+
+    const auto* valueEvent = reinterpret_cast<const clap_event_param_value_t*>(event);
+    const auto match = std::find_if(clapParameters.begin(), clapParameters.end(),
+                                    [valueEvent] (const ClapParameter& p) { return p.id == valueEvent->param_id; });
+    if(match == clapParameters.end()) {
+        return;
+    }
+
+    // the wrapper exposes every parameter normalised
+    const auto normalisedValue = juce::jlimit(0.0f, 1.0f, static_cast<float>(valueEvent->value));
+
+    if(match->automated.has_value()) {
+        addParameterEvent(*match->automated, sampleOffset, match->parameter->convertFrom0to1(normalisedValue));
+    }
+
+    pendingHostValues[static_cast<size_t>(std::distance(clapParameters.begin(), match))].store(normalisedValue);
+}
+
+template <typename SampleType>
+void AudioPluginAudioProcessor::applyParameterEvent(const ParameterEvent& event, ProcessingChain<SampleType>& chain)
+{
+    setSnapshotValue(event.parameter, event.value);
+
+    switch(event.parameter)
+    {
+        case AutomatedParameter::Active:
+        case AutomatedParameter::InputGain:
+        case AutomatedParameter::OutputGain:
+            updateMainParameters(chain);
+            break;
+        case AutomatedParameter::SampleRate:
+        case AutomatedParameter::AntiAliasing:
+            updateDPCMParameters(chain);
+            break;
+        case AutomatedParameter::Speaker:
+            updateSpeakerParameters(chain);
+            break;
+    }
+}
+
+void AudioPluginAudioProcessor::setSnapshotValue(AutomatedParameter parameter, float value)
+{
+    switch(parameter)
+    {
+        case AutomatedParameter::Active:       parameters.active    = value > 0.5f; break;
+        case AutomatedParameter::InputGain:    parameters.inGainDB  = value; break;
+        case AutomatedParameter::OutputGain:   parameters.outGainDB = value; break;
+        case AutomatedParameter::SampleRate:   parameters.sRate     = juce::roundToInt(value); break;
+        case AutomatedParameter::AntiAliasing: parameters.aaFilt    = value > 0.5f; break;
+        case AutomatedParameter::Speaker:      parameters.speaker   = juce::roundToInt(value); break;
+    }
 }
 
 //==============================================================================
@@ -297,13 +821,6 @@ void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeI
     apvts.replaceState(copyState);
 }
 
-//==============================================================================
-void AudioPluginAudioProcessor::readScopeData(float* data, int maxNumItems)
-{
-    auto size = juce::jmin(scopeData.getSizeToRead(), maxNumItems);
-    scopeData.readFromFifo(data, size);
-}
-
 //==============================================================================
 bool AudioPluginAudioProcessor::hasEditor() const
 {
@@ -3,11 +3,17 @@
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
 #include "DSP/DeltaModulation.h"
+#include "DSP/SpeakerBank.h"
+#include "DSP/LoadMeter.h"
+#include "DSP/ScopeReducer.h"
 #include <IA_Utilities/ParameterListener.hpp>
-#include <IA_Utilities/FiFo.hpp>
+#include <clap-juce-extensions/clap-juce-extensions.h>
+#include <optional>
 
 //==============================================================================
-class AudioPluginAudioProcessor final : public juce::AudioProcessor
+class AudioPluginAudioProcessor final : public juce::AudioProcessor,
+                                        public clap_juce_extensions::clap_juce_audio_processor_capabilities,
+                                        private juce::Timer
 {
 public:
     //==============================================================================
@@ -18,11 +24,21 @@ public:
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
+    /** Widest layout accepted by isBusesLayoutSupported(). */
+    static constexpr int maxNumChannels = 16;
+
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
 
+    // both precisions run the whole chain natively, so 64-bit hosts don't convert every block
+    bool supportsDoublePrecisionProcessing() const override { return true; }
+
+    // hosts don't have to re-prepare when a bounce starts or stops, so the filter tier follows this on the audio thread
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
     void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-    using AudioProcessor::processBlock;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -41,7 +57,7 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override { return tailLengthSeconds.load(); }
 
     //==============================================================================
     int getNumPrograms() override { return 1; }
@@ -55,10 +71,64 @@ public:
     }
 
     //==============================================================================
-    void readScopeData(float* data, int maxNumItems);
+    /** Parameters that can be changed part way through a block with addParameterEvent(). */
+    enum struct AutomatedParameter
+    {
+        Active,
+        InputGain,
+        OutputGain,
+        SampleRate,
+        AntiAliasing,
+        Speaker
+    };
+
+    /** Queues a parameter change at a sample offset within the next processBlock() call.
+        Values are in the parameter's own units (dB, index, 0/1). processBlock() splits the block at
+        each event, so automation lands on the same sample whatever the block size.
+        Call from the audio thread, before processBlock(). Returns false if the queue is full.
+
+        CLAP parameter events come through here (see handleDirectEvent()), the other formats still
+        apply host automation at the start of each block.
+    */
+    bool addParameterEvent(AutomatedParameter parameter, int sampleOffset, float value);
+
+    /** The AutomatedParameter for a parameter ID, or nothing for settings that can't be automated. */
+    static std::optional<AutomatedParameter> getAutomatedParameter(const juce::String& parameterID);
+
+    //==============================================================================
+    /** Takes CLAP parameter value events before the wrapper applies them to the whole block. */
+    bool supportsDirectEvent(uint16_t spaceId, uint16_t type) override;
+
+    /** Queues automatable parameters with addParameterEvent() at the event's offset. Every value is
+        also published for applyHostValues(), which moves the parameters (settings, and events that
+        don't fit in the queue, only take effect then). Lock free, this runs on the audio thread.
+    */
+    void handleDirectEvent(const clap_event_header_t* event, int sampleOffset) override;
+
+    /** Sets the parameters to the values the host sent through handleDirectEvent() and notifies their
+        listeners, so the editor and saved state follow the automation. Called by the timer, call it from
+        the message thread only.
+    */
+    void applyHostValues();
+
+    //==============================================================================
+    /** Share of each block's real-time duration spent processing it, averaged over LoadMeter::averagingTime.
+        Covers processBlock() and processBlockBypassed(). Safe to call from any thread.
+    */
+    float getAverageLoad() const { return loadMeter.getAverageLoad(); }
 
-    int getScopeNumSamplesToRead() { return scopeData.getSizeToRead(); }
-    int getScopeSize() { return scopeData.size(); }
+    /** Highest single block load since the last resetPeakLoad(). Safe to call from any thread. */
+    float getPeakLoad() const { return loadMeter.getPeakLoad(); }
+    void resetPeakLoad() { loadMeter.resetPeakLoad(); }
+
+    //==============================================================================
+    using ScopeColumns = ScopeReducer::Columns;
+
+    /** The output is only reduced for the scope while this is on, the editor turns it on while it exists. */
+    void setScopeActive(bool shouldBeActive) { scope.setActive(shouldBeActive); }
+
+    /** Copies the latest scope window into dest. Returns false if there is nothing new since the last call. */
+    bool readScope(ScopeColumns& dest) { return scope.read(dest); }
 
     float getInterfaceSizeRatio() { return sizeRatio; }
     void setInterfaceSizeRatio(float newRatio) { sizeRatio = newRatio; }
@@ -69,34 +139,167 @@ private:
 
     ParameterListener mainControlListener, dpcmControlListener, speakerListener;
 
-    void updateMainParameters();
-    void updateDPCMParameters();
-    void updateSpeakerParameters();
-    void updateAllParameters();
+    /** Everything that runs at the processing precision. Both chains exist, but only the one
+        matching isUsingDoublePrecision() is prepared and processed.
+    */
+    template <typename SampleType>
+    struct ProcessingChain
+    {
+        DeltaModulation<SampleType> dpcm;
+        SpeakerBank<SampleType> speaker;
+        std::unique_ptr<juce::dsp::DryWetMixer<SampleType>> mixer;
+
+        // the input delayed by the DPCM latency, fed in every block so bypass and latency switches always have it
+        juce::dsp::DelayLine<SampleType, juce::dsp::DelayLineInterpolationTypes::None> dryDelay;
+
+        juce::LinearSmoothedValue<SampleType> smOutGain { static_cast<SampleType>(1.0) };
+        std::vector<SampleType> outGainRamp;
 
-    float loadRawParameterValue(juce::StringRef parameterID) const
+        // low latency monitoring, the quality tiers and the engines swap while the output is the delayed dry:
+        // the wet fades out, the dry crossfades from the old alignment to the new one, then the wet fades back in
+        juce::LinearSmoothedValue<SampleType> latencySwitchGain { static_cast<SampleType>(1.0) };
+        juce::LinearSmoothedValue<SampleType> dryAlignment { static_cast<SampleType>(1.0) };
+        int dryDelayFrom = 0, dryDelayTo = 0;
+        std::vector<SampleType> latencySwitchRamp, dryAlignmentRamp;
+        juce::AudioBuffer<SampleType> alignedDry;
+    };
+
+    template <typename SampleType> void prepareChain (ProcessingChain<SampleType>& chain, double sampleRate, int samplesPerBlock);
+    template <typename SampleType> void processChain (juce::AudioBuffer<SampleType>& buffer, ProcessingChain<SampleType>& chain);
+    template <typename SampleType> void processChainBypassed (juce::AudioBuffer<SampleType>& buffer, ProcessingChain<SampleType>& chain);
+
+    template <typename SampleType> void updateMainParameters (ProcessingChain<SampleType>& chain);
+    template <typename SampleType> void updateDPCMParameters (ProcessingChain<SampleType>& chain);
+    template <typename SampleType> void updateSpeakerParameters (ProcessingChain<SampleType>& chain);
+    template <typename SampleType> void updateAllParameters (ProcessingChain<SampleType>& chain);
+
+    template <typename SampleType> const SampleType* getOutputGainRamp (ProcessingChain<SampleType>& chain, int numSamples);
+
+    /** Raw parameter values, looked up once in the constructor so the audio thread never searches by ID. */
+    struct ParameterHandles
     {
-        return apvts.getRawParameterValue(parameterID)->load();
-    }
+        std::atomic<float>* active  = nullptr;
+        std::atomic<float>* inGain  = nullptr;
+        std::atomic<float>* outGain = nullptr;
+        std::atomic<float>* sRate   = nullptr;
+        std::atomic<float>* aaFilt  = nullptr;
+        std::atomic<float>* speaker = nullptr;
+        std::atomic<float>* lowLatency = nullptr;
+        std::atomic<float>* engine = nullptr;
+    };
+
+    /** Parameter values as read at the start of a block. The update functions only read from this. */
+    struct ParameterSnapshot
+    {
+        bool active = true, aaFilt = true, lowLatency = false;
+        float inGainDB = 0.0f, outGainDB = 0.0f;
+        int sRate = 7, speaker = 0;
+    };
+
+    void readParameterSnapshot();
+
+    struct ParameterEvent
+    {
+        int sampleOffset;
+        AutomatedParameter parameter;
+        float value;
+    };
+
+    template <typename SampleType>
+    void applyParameterEvent(const ParameterEvent& event, ProcessingChain<SampleType>& chain);
+
+    /** Everything from the dry push to the wet mix, for one section of the block between parameter events. */
+    template <typename SampleType>
+    void processSection(juce::dsp::AudioBlock<SampleType> block, ProcessingChain<SampleType>& chain);
+
+    static constexpr size_t maxParameterEvents = 1024;
+    std::vector<ParameterEvent> parameterEvents;
+
+    /** Empties the queue once the block has used it. */
+    void clearParameterEvents();
+
+    /** Sets the snapshot value an event or a host value stands for, without updating the chain. */
+    void setSnapshotValue(AutomatedParameter parameter, float value);
+
+    /** A parameter under the id the CLAP wrapper gives it (the hash of its parameter ID). */
+    struct ClapParameter
+    {
+        clap_id id;
+        juce::RangedAudioParameter* parameter;
+        std::optional<AutomatedParameter> automated;
+    };
+
+    std::vector<ClapParameter> clapParameters;
+
+    // normalised values the host sent for each of clapParameters, waiting for applyHostValues(), negative when there is none.
+    // Setting a parameter notifies its listeners under a lock, so the audio thread only publishes them
+    std::vector<std::atomic<float>> pendingHostValues;
+
+    ParameterHandles parameterHandles;
+    ParameterSnapshot parameters;
 
     //==============================================================================
 
     static constexpr double smoothingTime = 15.0 * 0.0001;
-    juce::LinearSmoothedValue<float> smInGain {1.0f}, smOutGain {1.0f};
-    bool effectActive = true, speakerActive = false;
+    bool effectActive = true;
+
+    // when switched off, the wet chain stops once the mixer has faded it out (DryWetMixer ramps over 50ms)
+    static constexpr double mixerRampTime = 0.05;
+    int mixerRampSamples = 0, bypassFadeRemaining = 0;
+    bool wetChainIdle = false;
+
+    // the wet chain also sleeps once the input has been silent for longer than its tail
+    static constexpr float silenceThreshold = 1.0e-6f; // -120dB, matching DeltaModulation::tailDecayDB
+    std::atomic<double> tailLengthSeconds { 0.0 };
+    int tailLengthSamples = 0, silentSamples = 0;
+    bool wetChainAsleep = false;
+
+    static constexpr double latencySwitchTime = 0.01;
+    bool lowLatencyRequested = false, lowLatencyActive = false;
+    std::atomic<bool> renderingOffline { false };
+    bool offlineActive = false;
+
+    /** Steps the low latency, quality tier and engine switches along at the start of a block:
+        fade the wet out, swap and move the dry over to the new latency, fade the wet back in.
+    */
+    template <typename SampleType> void updateLatencySwitch (ProcessingChain<SampleType>& chain);
+
+    /** Feeds the dry delay, and while a latency switch is running reads the dry into alignedDry,
+        crossfading from the old latency to the new one.
+    */
+    template <typename SampleType> void pushAlignedDry (const juce::dsp::AudioBlock<SampleType>& block, ProcessingChain<SampleType>& chain, bool switching);
+
+    /** While a latency switch is running, fades the section's output to and from alignedDry. */
+    template <typename SampleType> void mixAlignedDry (juce::dsp::AudioBlock<SampleType>& block, ProcessingChain<SampleType>& chain, bool switching);
+
+    /** Lines the dry path and tail up with the DPCM latency, and queues it for the host. */
+    template <typename SampleType> void updateLatency (ProcessingChain<SampleType>& chain);
+
+    // setLatencySamples() takes a lock to notify the host, so the audio thread leaves it to timerCallback(),
+    // like the parameter values from handleDirectEvent()
+    std::atomic<int> latencyToReport { -1 };
+    static constexpr int latencyReportRate = 20;
+    void reportLatency();
+    void timerCallback() override;
+
+    /** The DPCM engine picked by the "engine" setting. updateLatencySwitch() follows it. */
+    template <typename SampleType> typename DeltaModulation<SampleType>::Engine getSelectedEngine() const;
+
+    /** Restarts the wet chain from clean state after it has been idle or asleep. */
+    template <typename SampleType> void wakeWetChain (ProcessingChain<SampleType>& chain);
     bool prepared = false;
-    int speakerChoice = -1;
+    size_t preparedBlockSize = 1;
+
+    ProcessingChain<float> floatChain;
+    ProcessingChain<double> doubleChain;
 
-    DeltaModulation<float> dpcm;
-    std::unique_ptr<juce::dsp::DryWetMixer<float>> mixer;
-    juce::dsp::Convolution speaker;
-    juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> bypassDelay;
+    LoadMeter loadMeter;
 
     //==============================================================================
 
     float sizeRatio = 1.0f;
-    static constexpr double scopeSize = 0.5;
-    Fifo<float> scopeData;
+    static constexpr double scopeWindow = 1.0 / 12.0; // one frame of the editor's 12Hz timer
+    ScopeReducer scope;
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPluginAudioProcessor)
@@ -2,37 +2,91 @@
 
 PixelScope::PixelScope()
 {
-    dataMin.resize(pixelsX);
-    dataMax.resize(pixelsX);
+    // silence, until the first data arrives
+    topRow.fill(pixelsY / 2);
+    bottomRow.fill(pixelsY / 2);
+    columnDirty.fill(true);
 
     addAndMakeVisible(background);
 }
 
 void PixelScope::paint (juce::Graphics& g)
 {
-    jassert(!dataMin.empty() && !dataMax.empty());
+    const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    updateRaster(scale);
 
-    g.setColour(juce::Colour(0xFF2A2E0D));
+    if(raster.isValid()) {
+        g.drawImageTransformed(raster, juce::AffineTransform::scale(1.0f / rasterScale));
+    }
+}
+
+void PixelScope::updateRaster(float scale)
+{
+    const auto width = juce::roundToInt(static_cast<float>(getWidth()) * scale);
+    const auto height = juce::roundToInt(static_cast<float>(getHeight()) * scale);
+
+    if(width <= 0 || height <= 0) {
+        return;
+    }
+
+    if(!raster.isValid() || raster.getWidth() != width || raster.getHeight() != height || rasterScale != scale)
+    {
+        raster = juce::Image(juce::Image::ARGB, width, height, true);
+        rasterScale = scale;
+        columnDirty.fill(true);
+    }
 
+    if(std::none_of(columnDirty.begin(), columnDirty.end(), [] (bool dirty) { return dirty; })) {
+        return;
+    }
+
+    // clear the changed columns first, then draw them again
     for(int i = 0; i < pixelsX; ++i)
     {
-        auto yPos = dataMax[i];
-        do
-        {
-            g.fillRect(i * cachedColW,
-                    yPos * cachedH,
-                    pixelSize, pixelSize
-            );
-            yPos += 1.0f / pixelsYfloat;
-        } while (yPos <= dataMin[i]);
+        if(columnDirty[static_cast<size_t>(i)]) {
+            const auto column = getPixelArea(i, 0).withHeight(cachedH) * scale;
+            raster.clear(column.getSmallestIntegerContainer());
+        }
+    }
+
+    juce::Graphics rasterGraphics(raster);
+    rasterGraphics.addTransform(juce::AffineTransform::scale(scale));
+    rasterGraphics.setColour(juce::Colour(0xFF2A2E0D));
+
+    for(int i = 0; i < pixelsX; ++i)
+    {
+        auto& dirty = columnDirty[static_cast<size_t>(i)];
+        if(!dirty) {
+            continue;
+        }
+
+        for(int row = topRow[static_cast<size_t>(i)]; row <= bottomRow[static_cast<size_t>(i)]; ++row) {
+            rasterGraphics.fillRect(getPixelArea(i, row));
+        }
+        dirty = false;
     }
 }
 
+juce::Rectangle<float> PixelScope::getPixelArea(int column, int row) const
+{
+    return { static_cast<float>(column) * cachedColW,
+             static_cast<float>(row) * cachedH / pixelsYfloat,
+             pixelSize, pixelSize };
+}
+
+juce::Rectangle<int> PixelScope::getCellArea(juce::Rectangle<int> cells) const
+{
+    return getPixelArea(cells.getX(), cells.getY())
+        .getUnion(getPixelArea(cells.getRight() - 1, cells.getBottom() - 1))
+        .getSmallestIntegerContainer();
+}
+
 void PixelScope::resized()
 {
     background.setBounds(getLocalBounds());
     cachedColW = float(getWidth()) / float(pixelsX);
     cachedH    = float(getHeight());
+    raster = {};
 }
 
 void PixelScope::setDataAt(int index, float minValue, float maxValue)
@@ -44,11 +98,33 @@ void PixelScope::setDataAt(int index, float minValue, float maxValue)
         return;
     }
 
-    minValue = normalizeValue(minValue);
-    maxValue = normalizeValue(maxValue);
+    const auto column = static_cast<size_t>(index);
+    const auto top = juce::roundToInt(normalizeValue(maxValue) * pixelsYfloat);
+    const auto bottom = juce::jmax(top, juce::roundToInt(normalizeValue(minValue) * pixelsYfloat));
+
+    if(top == topRow[column] && bottom == bottomRow[column]) {
+        return;
+    }
+
+    // both the old and the new pixels have to be repainted
+    const auto firstRow = juce::jmin(top, topRow[column]);
+    const auto lastRow = juce::jmax(bottom, bottomRow[column]);
+    const auto cells = juce::Rectangle<int>(index, firstRow, 1, lastRow - firstRow + 1);
+    dirtyCells = dirtyCells.isEmpty() ? cells : dirtyCells.getUnion(cells);
+
+    topRow[column] = top;
+    bottomRow[column] = bottom;
+    columnDirty[column] = true;
+}
+
+void PixelScope::repaintChanges()
+{
+    if(dirtyCells.isEmpty()) {
+        return;
+    }
 
-    dataMin[index] = std::round(minValue * pixelsYfloat) / pixelsYfloat;
-    dataMax[index] = std::round(maxValue * pixelsYfloat) / pixelsYfloat;
+    repaint(getCellArea(dirtyCells));
+    dirtyCells = {};
 }
 
 void PixelScope::setSizeRatio(float newSizeRatio)
@@ -56,6 +132,7 @@ void PixelScope::setSizeRatio(float newSizeRatio)
     pixelSize = 4.0f * newSizeRatio;
     background.setPixelSize(pixelSize);
     background.setPixelOffset(pixelSize * 0.5f);
+    raster = {};
 }
 
 //==============================================================================
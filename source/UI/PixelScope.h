@@ -13,6 +13,9 @@ public:
     void setDataAt(int index, float minValue, float maxValue);
     void setSizeRatio(float newSizeRatio);
 
+    /** Repaints only the area covered by columns that changed in setDataAt() since the last call. */
+    void repaintChanges();
+
     constexpr int getDataSize() const { return pixelsX; }
 
 private:
@@ -25,8 +28,18 @@ private:
     float cachedColW = 0.0f;
     float cachedH    = 0.0f;
 
-    std::vector<float> dataMin;
-    std::vector<float> dataMax;
+    // lit rows per column, top to bottom inclusive (0 and 1 both map to a row, so there are pixelsY + 1)
+    std::array<int, pixelsX> topRow, bottomRow;
+
+    // the lit pixels are kept in a raster at the display scale, only columns that changed are redrawn into it
+    juce::Image raster;
+    float rasterScale = 0.0f;
+    std::array<bool, pixelsX> columnDirty;
+    juce::Rectangle<int> dirtyCells; // columns and rows to repaint, in grid units
+
+    void updateRaster(float scale);
+    juce::Rectangle<float> getPixelArea(int column, int row) const;
+    juce::Rectangle<int> getCellArea(juce::Rectangle<int> cells) const;
 
     static float normalizeValue(float in)
     {
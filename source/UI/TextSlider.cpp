@@ -12,40 +12,51 @@ TextSlider::TextSlider()
 }
 
 void TextSlider::paint (juce::Graphics& g)
+{
+    const auto readout = getReadout();
+
+    if(!(shadowCachedByParent && hasStaticShadow())) {
+        drawShadow(g, readout);
+    }
+
+    g.setFont(readout.font);
+    g.setColour(getLookAndFeel().findColour(juce::Slider::ColourIds::textBoxTextColourId));
+    g.drawText(readout.text, getLocalBounds().toFloat(), juce::Justification::centredRight, false);
+}
+
+void TextSlider::paintShadow(juce::Graphics& g)
+{
+    drawShadow(g, getReadout());
+}
+
+void TextSlider::drawShadow(juce::Graphics& g, const Readout& readout)
+{
+    g.setFont(readout.font);
+    g.setColour(getLookAndFeel().findColour(juce::Slider::ColourIds::backgroundColourId));
+    g.drawText(readout.shadowText, getLocalBounds().toFloat().translated(offset, offset), juce::Justification::centredRight, false);
+}
+
+TextSlider::Readout TextSlider::getReadout() const
 {
     auto val = getValue();
     auto units = getTextValueSuffix();
-    auto bounds = getLocalBounds().toFloat();
 
-    juce::String bgText;
     auto text = juce::String(val, digitalReadout ? 0 : numDecimals, false);
 
-    if(digitalReadout)
-    {
-        bgText = "88";
-
-        g.setFont(juce::Font(juce::FontOptions(digitalTypeface)).withPointHeight(fontHeight));
+    if(digitalReadout) {
+        return { text, "88", juce::Font(juce::FontOptions(digitalTypeface)).withPointHeight(fontHeight) };
     }
-    else
+
+    text << units;
+    if(val >= 0)
     {
-        text << units;
-        if(val >= 0)
-        {
-            if(text.startsWith("-")) {
-                text = text.trimCharactersAtStart("-");
-            }
-            text = "+" + text;
+        if(text.startsWith("-")) {
+            text = text.trimCharactersAtStart("-");
         }
-        bgText = text;
-
-        g.setFont(juce::Font(juce::FontOptions().withPointHeight(fontHeight)));
+        text = "+" + text;
     }
 
-    g.setColour(getLookAndFeel().findColour(juce::Slider::ColourIds::backgroundColourId));
-    g.drawText(bgText, bounds.translated(offset, offset), juce::Justification::centredRight, false);
-
-    g.setColour(getLookAndFeel().findColour(juce::Slider::ColourIds::textBoxTextColourId));
-    g.drawText(text, bounds, juce::Justification::centredRight, false);
+    return { text, text, juce::Font(juce::FontOptions().withPointHeight(fontHeight)) };
 }
 
 void TextSlider::setUseDigitalReadout(bool shouldBeDigital)
@@ -67,3 +78,9 @@ void TextSlider::setShadowOffset(float newOffset)
 {
     offset = newOffset;
 }
+
+void TextSlider::setShadowCachedByParent(bool shouldBeCached)
+{
+    shadowCachedByParent = shouldBeCached;
+    repaint();
+}
@@ -15,9 +15,28 @@ public:
     void setFontHeight(float newHeight);
     void setShadowOffset(float newOffset);
 
+    /** True when the shadow doesn't change with the value (the digital readout's "88"). */
+    bool hasStaticShadow() const { return digitalReadout; }
+
+    /** Stops paint() drawing a static shadow, for a parent that caches it with paintShadow() instead. */
+    void setShadowCachedByParent(bool shouldBeCached);
+
+    /** Draws only the shadow, in the slider's own coordinates. */
+    void paintShadow(juce::Graphics& g);
+
 private:
 
+    struct Readout
+    {
+        juce::String text, shadowText;
+        juce::Font font;
+    };
+
+    Readout getReadout() const;
+    void drawShadow(juce::Graphics& g, const Readout& readout);
+
     bool digitalReadout = false;
+    bool shadowCachedByParent = false;
     int numDecimals = 1;
 
     float offset = 2.0f;
@@ -0,0 +1,218 @@
+/*
+    Golden render test, registered with CTest (see cmake/Tests.cmake).
+
+    Renders a short test signal through DeltaModulation::processEngine() for every engine variant the
+    plugin can run, at 44.1kHz where the Oversampled engine has to resample: both quality tiers and the
+    low latency filters, and the TickSampled engine in both tiers and with linear phase steps. Each render,
+    in both precisions, is compared against the one committed under tests/golden. processEngine() leaves
+    out the host rate filters, so the renders only depend on the resamplers, the tick kernels and the
+    quantiser in this repository, not on JUCE's filters.
+
+    The comparison is statistical, like the fast math check in benchmarks/Verification.h: a build that
+    contracts or reorders floating point differently may move a single quantiser decision, after which the
+    counter takes a different but equally valid path. At most maxMismatchRatio of the samples may differ
+    by more than sampleTolerance, and the RMS of the difference must stay below maxRMSError.
+
+    Usage: Tests --golden <dir>
+           Tests --write-golden <dir>
+
+    --golden <dir>        compare against the renders in dir (CTest passes tests/golden)
+    --write-golden <dir>  write the renders to dir instead, after a deliberate change to the engine
+
+    Goldens are rendered in double precision and stored as raw little-endian floats, channel after
+    channel. One CSV row is printed per variant and precision. Returns 0 if every render matched.
+*/
+
+#include <juce_core/juce_core.h>
+#include <iostream>
+#include "DSP/DeltaModulation.h"
+
+namespace
+{
+    constexpr double sampleRate = 44100.0;
+    constexpr int numChannels = 2;
+    constexpr int maxBlockSize = 512;
+    constexpr int blockSize = 97; // odd on purpose, so ticks and SIMD groups land at every offset in a block
+    constexpr double renderSeconds = 0.04;
+
+    constexpr double sampleTolerance  = 1.0e-4;
+    constexpr double maxMismatchRatio = 1.0e-3;
+    constexpr double maxRMSError      = 1.0e-3;
+
+    /** A sine on a DC offset that keeps the gate open, cut off part way so the gate closes and the filters ring out. */
+    double generate (int channel, double time)
+    {
+        if(time >= 0.6 * renderSeconds) {
+            return 0.0;
+        }
+        return 0.5 + 0.3 * std::sin(juce::MathConstants<double>::twoPi * (997.0 + 113.0 * channel) * time);
+    }
+
+    struct EngineVariant
+    {
+        const char* name;
+        bool tickSampled, offline, lowLatency, linearPhaseSteps;
+    };
+
+    const std::array<EngineVariant, 6> engineVariants
+    {{
+        { "oversampled_realtime",    false, false, false, false },
+        { "oversampled_offline",     false, true,  false, false },
+        { "oversampled_low_latency", false, false, true,  false },
+        { "tick_realtime",           true,  false, false, false },
+        { "tick_offline",            true,  true,  false, false },
+        { "tick_linear_steps",       true,  false, false, true },
+    }};
+
+    template <typename SampleType>
+    juce::AudioBuffer<SampleType> render (const EngineVariant& variant)
+    {
+        using Processor = DeltaModulation<SampleType>;
+
+        Processor processor;
+        processor.setEngine(variant.tickSampled ? Processor::Engine::TickSampled : Processor::Engine::Oversampled);
+        processor.setStepShape(variant.linearPhaseSteps ? Processor::StepShape::LinearPhase : Processor::StepShape::MinimumPhase);
+        processor.prepare({ sampleRate, static_cast<juce::uint32>(maxBlockSize), numChannels });
+
+        // switched after prepare(), the way the plugin switches them
+        processor.setQuality(variant.offline ? Processor::Quality::Offline : Processor::Quality::Realtime);
+        processor.setLowLatency(variant.lowLatency);
+        processor.setSystem(Processor::System::PAL);
+        processor.setSampleRate(7);
+
+        const auto numSamples = static_cast<int>(renderSeconds * sampleRate);
+        juce::AudioBuffer<SampleType> buffer(numChannels, numSamples);
+
+        for(int c = 0; c < numChannels; ++c) {
+            for(int s = 0; s < numSamples; ++s) {
+                buffer.setSample(c, s, static_cast<SampleType>(generate(c, s / sampleRate)));
+            }
+        }
+
+        auto whole = juce::dsp::AudioBlock<SampleType>(buffer);
+        for(size_t start = 0; start < whole.getNumSamples(); start += blockSize) {
+            processor.processEngine(whole.getSubBlock(start, juce::jmin(static_cast<size_t>(blockSize), whole.getNumSamples() - start)));
+        }
+        return buffer;
+    }
+
+    bool writeGolden (const juce::File& file, const juce::AudioBuffer<double>& buffer)
+    {
+        file.deleteFile();
+        juce::FileOutputStream stream(file);
+
+        if(!stream.openedOk()) {
+            return false;
+        }
+
+        for(int c = 0; c < buffer.getNumChannels(); ++c) {
+            for(int s = 0; s < buffer.getNumSamples(); ++s) {
+                stream.writeFloat(static_cast<float>(buffer.getSample(c, s)));
+            }
+        }
+        return true;
+    }
+
+    bool readGolden (const juce::File& file, juce::AudioBuffer<double>& buffer)
+    {
+        juce::FileInputStream stream(file);
+
+        if(!stream.openedOk() || stream.getTotalLength() != static_cast<juce::int64>(sizeof(float)) * buffer.getNumChannels() * buffer.getNumSamples()) {
+            return false;
+        }
+
+        for(int c = 0; c < buffer.getNumChannels(); ++c) {
+            for(int s = 0; s < buffer.getNumSamples(); ++s) {
+                buffer.setSample(c, s, static_cast<double>(stream.readFloat()));
+            }
+        }
+        return true;
+    }
+
+    void printRow (const juce::StringArray& row)
+    {
+        std::cout << row.joinIntoString(",") << std::endl;
+    }
+
+    /** Renders the variant in one precision and compares it against the golden render. Returns true if it matched. */
+    template <typename SampleType>
+    bool check (const EngineVariant& variant, const juce::AudioBuffer<double>& golden)
+    {
+        const auto actual = render<SampleType>(variant);
+
+        int numMismatches = 0;
+        auto maxError = 0.0, sumSquares = 0.0;
+
+        for(int c = 0; c < golden.getNumChannels(); ++c)
+        {
+            for(int s = 0; s < golden.getNumSamples(); ++s)
+            {
+                const auto error = std::abs(golden.getSample(c, s) - static_cast<double>(actual.getSample(c, s)));
+
+                maxError = juce::jmax(maxError, error);
+                sumSquares += error * error;
+                numMismatches += error > sampleTolerance ? 1 : 0;
+            }
+        }
+
+        const auto numSamples = golden.getNumChannels() * golden.getNumSamples();
+        const auto rmsError = std::sqrt(sumSquares / juce::jmax(1, numSamples));
+        const auto passed = numMismatches <= maxMismatchRatio * numSamples && rmsError <= maxRMSError;
+
+        printRow({ variant.name, std::is_same_v<SampleType, float> ? "float" : "double", juce::String(maxError, 10),
+                   juce::String(rmsError, 10), juce::String(numMismatches), passed ? "pass" : "FAIL" });
+        return passed;
+    }
+
+    int printUsage()
+    {
+        std::cerr << "Usage: Tests --golden <dir> | --write-golden <dir>" << std::endl;
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if(args.containsOption("--write-golden"))
+    {
+        const auto directory = args.getFileForOption("--write-golden");
+        directory.createDirectory();
+
+        for(const auto& variant : engineVariants)
+        {
+            if(!writeGolden(directory.getChildFile(juce::String(variant.name) + ".f32"), render<double>(variant))) {
+                std::cerr << "Could not write the golden render for " << variant.name << std::endl;
+                return 1;
+            }
+        }
+        return 0;
+    }
+
+    if(!args.containsOption("--golden")) {
+        return printUsage();
+    }
+
+    const auto directory = args.getFileForOption("--golden");
+    int numFailures = 0;
+
+    printRow({ "variant", "precision", "max_error", "rms_error", "mismatches", "result" });
+
+    for(const auto& variant : engineVariants)
+    {
+        juce::AudioBuffer<double> golden(numChannels, static_cast<int>(renderSeconds * sampleRate));
+        if(!readGolden(directory.getChildFile(juce::String(variant.name) + ".f32"), golden)) {
+            std::cerr << "Missing or mismatched golden render for " << variant.name << std::endl;
+            ++numFailures;
+            continue;
+        }
+
+        numFailures += check<float>(variant, golden) ? 0 : 1;
+        numFailures += check<double>(variant, golden) ? 0 : 1;
+    }
+
+    std::cout << (numFailures == 0 ? "All renders matched" : juce::String(numFailures) + " renders did not match") << std::endl;
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+/*
+    Headless batch renderer.
+
+    Streams every input file through the full plugin (AudioPluginAudioProcessor) once per parameter
+    set and writes the results as WAV. The processor's latency is compensated, so each output lines up
+    sample for sample with its input, and files are rendered in parallel on a work-stealing pool.
+
+    Usage: BatchRenderer [options] <input files...>
+
+    --output <dir>        where renders go (default: next to each input). Files are named <input>_<set>.wav
+    --params <file>       parameter sets, one per line: <name> <id>=<value> <id>@<seconds>=<value> ...
+                          ('#' starts a comment)
+    --set "<name> <id>=<value> <id>@<seconds>=<value> ..."
+                          one more parameter set, may be given several times
+    --tail                also render the plugin's tail after the end of the input
+    --bits <16|24|32>     output bit depth, 32 is float (default 24)
+    --block <samples>     processing block size (default 512)
+    --jobs <n>            number of threads (default: all cores)
+
+    Ids are the plugin's parameter ids (active, inGain, outGain, sRate, aaFilt, speaker, engine), values are in
+    the parameter's own units (dB, index, 0/1) or its display text ("B" for speaker B). Parameters left
+    out of a set keep their defaults. Without any sets every file is rendered once with the defaults.
+
+    <id>@<seconds>=<value> changes an automatable parameter at that time into the input. The change is
+    queued with addParameterEvent() at its exact sample, so renders don't depend on --block.
+*/
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_events/juce_events.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <mutex>
+#include "PluginProcessor.h"
+#include "WorkStealingPool.h"
+
+namespace
+{
+    using AutomatedParameter = AudioPluginAudioProcessor::AutomatedParameter;
+
+    struct AutomationPoint
+    {
+        juce::String id;
+        double time;
+        juce::String value;
+    };
+
+    struct ParameterSet
+    {
+        juce::String name;
+        juce::StringPairArray values;
+        std::vector<AutomationPoint> automation;
+    };
+
+    /** An automation point resolved for one render. */
+    struct TimedEvent
+    {
+        juce::int64 position;
+        AutomatedParameter parameter;
+        float value;
+    };
+
+    struct Options
+    {
+        juce::File outputDirectory;
+        bool renderTail = false;
+        int bitDepth = 24;
+        int blockSize = 512;
+        int numThreads = 0;
+    };
+
+    //==============================================================================
+    /** Parses "<name> <id>=<value> ...". Returns false and fills error if the line is malformed. */
+    bool parseParameterSet (const juce::String& line, ParameterSet& set, juce::String& error)
+    {
+        auto tokens = juce::StringArray::fromTokens(line, " \t", "\"");
+        tokens.removeEmptyStrings();
+
+        if(tokens.isEmpty() || tokens[0].containsChar('=')) {
+            error = "parameter set has no name: " + line;
+            return false;
+        }
+
+        set.name = tokens[0];
+        for(int i = 1; i < tokens.size(); ++i)
+        {
+            if(!tokens[i].containsChar('=')) {
+                error = "expected <id>=<value> in set " + set.name + ", got " + tokens[i];
+                return false;
+            }
+
+            const auto key = tokens[i].upToFirstOccurrenceOf("=", false, false);
+            const auto value = tokens[i].fromFirstOccurrenceOf("=", false, false).unquoted();
+
+            if(key.containsChar('@')) {
+                set.automation.push_back({ key.upToFirstOccurrenceOf("@", false, false),
+                                           key.fromFirstOccurrenceOf("@", false, false).getDoubleValue(), value });
+            }
+            else {
+                set.values.set(key, value);
+            }
+        }
+        return true;
+    }
+
+    bool readParameterSets (const juce::File& file, std::vector<ParameterSet>& sets, juce::String& error)
+    {
+        if(!file.existsAsFile()) {
+            error = "cannot find " + file.getFullPathName();
+            return false;
+        }
+
+        juce::StringArray lines;
+        file.readLines(lines);
+
+        for(auto line : lines)
+        {
+            line = line.upToFirstOccurrenceOf("#", false, false).trim();
+            if(line.isEmpty()) {
+                continue;
+            }
+
+            ParameterSet set;
+            if(!parseParameterSet(line, set, error)) {
+                return false;
+            }
+            sets.push_back(set);
+        }
+        return true;
+    }
+
+    /** Numbers are taken in the parameter's own units, anything else goes through its text conversion. */
+    float getValueInUnits (const juce::RangedAudioParameter& parameter, const juce::String& text)
+    {
+        const auto isNumber = text.containsOnly("+-.0123456789eE") && text.containsAnyOf("0123456789");
+        return isNumber ? text.getFloatValue() : parameter.convertFrom0to1(parameter.getValueForText(text));
+    }
+
+    bool applyParameterSet (AudioPluginAudioProcessor& processor, const ParameterSet& set, juce::String& error)
+    {
+        for(const auto& id : set.values.getAllKeys())
+        {
+            auto* parameter = processor.apvts.getParameter(id);
+            if(parameter == nullptr) {
+                error = "unknown parameter " + id + " in set " + set.name;
+                return false;
+            }
+
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(getValueInUnits(*parameter, set.values[id])));
+        }
+        return true;
+    }
+
+    /** Turns the set's automation into sample positions at sampleRate, in time order. */
+    bool getTimedEvents (AudioPluginAudioProcessor& processor, const ParameterSet& set, double sampleRate,
+                         std::vector<TimedEvent>& events, juce::String& error)
+    {
+        for(const auto& point : set.automation)
+        {
+            const auto* parameter = processor.apvts.getParameter(point.id);
+            const auto automated = AudioPluginAudioProcessor::getAutomatedParameter(point.id);
+
+            if(parameter == nullptr || !automated.has_value()) {
+                error = "cannot automate " + point.id + " in set " + set.name;
+                return false;
+            }
+
+            events.push_back({ static_cast<juce::int64>(std::round(juce::jmax(0.0, point.time) * sampleRate)), *automated,
+                               getValueInUnits(*parameter, point.value) });
+        }
+
+        std::stable_sort(events.begin(), events.end(), [] (const TimedEvent& a, const TimedEvent& b) { return a.position < b.position; });
+        return true;
+    }
+
+    //==============================================================================
+    /** Renders one file with one parameter set. Returns an empty string on success, otherwise the error. */
+    juce::String render (const juce::File& input, const ParameterSet& set, const juce::File& output, const Options& options)
+    {
+        juce::AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+        if(reader == nullptr) {
+            return "cannot read " + input.getFullPathName();
+        }
+
+        const auto numChannels = static_cast<int>(reader->numChannels);
+        const auto sampleRate = reader->sampleRate;
+
+        if(numChannels > AudioPluginAudioProcessor::maxNumChannels) {
+            return input.getFileName() + " has " + juce::String(numChannels) + " channels, the plugin supports up to "
+                 + juce::String(AudioPluginAudioProcessor::maxNumChannels);
+        }
+
+        AudioPluginAudioProcessor processor;
+
+        juce::String error;
+        if(!applyParameterSet(processor, set, error)) {
+            return error;
+        }
+
+        std::vector<TimedEvent> events;
+        if(!getTimedEvents(processor, set, sampleRate, events, error)) {
+            return error;
+        }
+        auto nextEvent = events.begin();
+
+        processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, options.blockSize);
+        processor.setNonRealtime(true);
+        processor.prepareToPlay(sampleRate, options.blockSize);
+
+        // the first latency samples out are the processor filling up, they are dropped and the same
+        // number of samples is pushed through after the end of the input to flush it
+        const auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+        const auto tail = options.renderTail ? static_cast<juce::int64>(std::ceil(processor.getTailLengthSeconds() * sampleRate)) : 0;
+        const auto numInputSamples = reader->lengthInSamples;
+        const auto numOutputSamples = numInputSamples + tail;
+
+        output.deleteFile();
+        std::unique_ptr<juce::OutputStream> stream = output.createOutputStream();
+        if(stream == nullptr) {
+            return "cannot write " + output.getFullPathName();
+        }
+
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(stream.get(), sampleRate, static_cast<unsigned int>(numChannels),
+                                                                            options.bitDepth, reader->metadataValues, 0));
+        if(writer == nullptr) {
+            return "cannot create a " + juce::String(options.bitDepth) + " bit WAV writer for " + output.getFullPathName();
+        }
+        juce::ignoreUnused(stream.release()); // the writer owns it now
+
+        juce::AudioBuffer<float> buffer(numChannels, options.blockSize);
+        juce::MidiBuffer midi;
+
+        juce::int64 readPosition = 0, written = 0;
+        auto toSkip = latency;
+
+        while(written < numOutputSamples)
+        {
+            const auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(options.blockSize), numOutputSamples + latency - readPosition));
+            const auto numToRead = static_cast<int>(juce::jlimit(juce::int64(0), static_cast<juce::int64>(numSamples), numInputSamples - readPosition));
+
+            buffer.setSize(numChannels, numSamples, false, false, true);
+            buffer.clear();
+            if(numToRead > 0) {
+                reader->read(&buffer, 0, numToRead, readPosition, true, true);
+            }
+
+            // automation falling inside this block lands on its sample, whatever the block size
+            for(; nextEvent != events.end() && nextEvent->position < readPosition + numSamples; ++nextEvent)
+            {
+                if(!processor.addParameterEvent(nextEvent->parameter, static_cast<int>(nextEvent->position - readPosition), nextEvent->value)) {
+                    return "too many automation points in one block for set " + set.name + ", try a smaller --block";
+                }
+            }
+            readPosition += numSamples;
+
+            processor.processBlock(buffer, midi);
+
+            const auto skipped = static_cast<int>(juce::jmin(toSkip, static_cast<juce::int64>(numSamples)));
+            toSkip -= skipped;
+
+            const auto numToWrite = static_cast<int>(juce::jmin(static_cast<juce::int64>(numSamples - skipped), numOutputSamples - written));
+            if(numToWrite > 0)
+            {
+                if(!writer->writeFromAudioSampleBuffer(buffer, skipped, numToWrite)) {
+                    return "write failed for " + output.getFullPathName();
+                }
+                written += numToWrite;
+            }
+        }
+
+        processor.releaseResources();
+        return {};
+    }
+
+    juce::File getOutputFile (const juce::File& input, const ParameterSet& set, const Options& options)
+    {
+        const auto directory = options.outputDirectory == juce::File() ? input.getParentDirectory() : options.outputDirectory;
+        return directory.getChildFile(input.getFileNameWithoutExtension() + "_" + juce::File::createLegalFileName(set.name) + ".wav");
+    }
+
+    int printUsage()
+    {
+        std::cerr << "Usage: BatchRenderer [--output <dir>] [--params <file>] [--set \"<name> <id>=<value> ...\"] "
+                     "[--tail] [--bits <16|24|32>] [--block <samples>] [--jobs <n>] <input files...>" << std::endl;
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Options options;
+    std::vector<ParameterSet> sets;
+    juce::Array<juce::File> inputs;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+        const auto hasValue = i + 1 < argc;
+        juce::String error;
+
+        if(arg == "--tail") {
+            options.renderTail = true;
+        }
+        else if(arg == "--output" && hasValue) {
+            options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]);
+        }
+        else if(arg == "--params" && hasValue) {
+            if(!readParameterSets(juce::File::getCurrentWorkingDirectory().getChildFile(argv[++i]), sets, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+        else if(arg == "--set" && hasValue) {
+            ParameterSet set;
+            if(!parseParameterSet(argv[++i], set, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            sets.push_back(set);
+        }
+        else if(arg == "--bits" && hasValue) {
+            options.bitDepth = juce::String(argv[++i]).getIntValue();
+        }
+        else if(arg == "--block" && hasValue) {
+            options.blockSize = juce::jmax(1, juce::String(argv[++i]).getIntValue());
+        }
+        else if(arg == "--jobs" && hasValue) {
+            options.numThreads = juce::String(argv[++i]).getIntValue();
+        }
+        else if(arg.startsWith("--")) {
+            return printUsage();
+        }
+        else {
+            inputs.add(juce::File::getCurrentWorkingDirectory().getChildFile(arg));
+        }
+    }
+
+    if(inputs.isEmpty() || (options.bitDepth != 16 && options.bitDepth != 24 && options.bitDepth != 32)) {
+        return printUsage();
+    }
+
+    if(sets.empty()) {
+        sets.push_back({ "default", {} });
+    }
+
+    if(options.outputDirectory != juce::File()) {
+        options.outputDirectory.createDirectory();
+    }
+
+    const auto numThreads = options.numThreads > 0 ? options.numThreads : juce::SystemStats::getNumCpus();
+    WorkStealingPool pool(numThreads);
+
+    std::mutex printLock;
+    std::atomic<int> numFailures { 0 };
+
+    for(const auto& input : inputs)
+    for(const auto& set : sets)
+    {
+        pool.addJob([&, input, set]
+        {
+            const auto output = getOutputFile(input, set, options);
+            const auto error = render(input, set, output, options);
+
+            const std::scoped_lock lock(printLock);
+            if(error.isEmpty()) {
+                std::cout << output.getFullPathName() << std::endl;
+            }
+            else {
+                std::cerr << "Failed: " << error << std::endl;
+                ++numFailures;
+            }
+        });
+    }
+
+    pool.run();
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** Runs a fixed list of jobs over a set of threads.
+
+    Jobs are dealt out round robin, one queue per thread. Each thread works from the front of its
+    own queue and, once that is empty, steals from the back of the others, so a few long files
+    don't leave the rest of the cores idle at the end of a batch.
+*/
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void()>;
+
+    explicit WorkStealingPool (int numThreadsToUse)
+        : queues(static_cast<size_t>(std::max(1, numThreadsToUse)))
+    {
+    }
+
+    void addJob (Job job)
+    {
+        auto& queue = queues[nextQueue];
+        nextQueue = (nextQueue + 1) % queues.size();
+
+        const std::scoped_lock lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    /** Runs every job added so far and returns once they have all finished. */
+    void run()
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(queues.size());
+
+        for(size_t i = 0; i < queues.size(); ++i) {
+            threads.emplace_back([this, i] { work(i); });
+        }
+
+        for(auto& t : threads) {
+            t.join();
+        }
+    }
+
+private:
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void work (size_t index)
+    {
+        for(;;)
+        {
+            Job job;
+
+            if(!popFront(queues[index], job))
+            {
+                // nothing left here, look for work in the other queues
+                bool stolen = false;
+                for(size_t offset = 1; offset < queues.size() && !stolen; ++offset) {
+                    stolen = popBack(queues[(index + offset) % queues.size()], job);
+                }
+
+                // jobs are never added while running, so empty everywhere means done
+                if(!stolen) {
+                    return;
+                }
+            }
+
+            job();
+        }
+    }
+
+    static bool popFront (Queue& queue, Job& job)
+    {
+        const std::scoped_lock lock(queue.mutex);
+        if(queue.jobs.empty()) {
+            return false;
+        }
+        job = std::move(queue.jobs.front());
+        queue.jobs.pop_front();
+        return true;
+    }
+
+    static bool popBack (Queue& queue, Job& job)
+    {
+        const std::scoped_lock lock(queue.mutex);
+        if(queue.jobs.empty()) {
+            return false;
+        }
+        job = std::move(queue.jobs.back());
+        queue.jobs.pop_back();
+        return true;
+    }
+
+    std::vector<Queue> queues;
+    size_t nextQueue = 0;
+};
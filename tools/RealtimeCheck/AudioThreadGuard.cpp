@@ -0,0 +1,239 @@
+#include "AudioThreadGuard.h"
+#include <juce_core/juce_core.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+#if JUCE_LINUX && defined(__GLIBC__)
+ #define SLOPE_INTERPOSE_LIBC 1
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <sched.h>
+ #include <cerrno>
+
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void  __libc_free (void*);
+    void* __libc_memalign (size_t, size_t);
+}
+#else
+ #define SLOPE_INTERPOSE_LIBC 0
+#endif
+
+namespace
+{
+    enum struct Violation
+    {
+        Allocation,
+        Deallocation,
+        Lock
+    };
+
+    // constant initialised, so reading them never allocates, not even the first time on a thread
+    thread_local bool guarded = false;
+    thread_local bool reporting = false;
+
+    std::atomic<int> numViolations { 0 }, reportsLeft { 10 };
+    std::atomic<const char*> context { "" };
+
+    void report (Violation violation) noexcept
+    {
+        if(!guarded || reporting) {
+            return;
+        }
+
+        // everything below allocates, which must not land back in here
+        reporting = true;
+        ++numViolations;
+
+        if(reportsLeft.fetch_sub(1) > 0)
+        {
+            const char* what = violation == Violation::Allocation   ? "allocation"
+                             : violation == Violation::Deallocation ? "deallocation"
+                                                                    : "mutex lock";
+
+            std::cerr << "\nRealtime violation (" << what << ") while " << context.load() << "\n"
+                      << juce::SystemStats::getStackBacktrace() << std::endl;
+        }
+
+        reporting = false;
+    }
+
+    void* rawAllocate (size_t size) noexcept
+    {
+       #if SLOPE_INTERPOSE_LIBC
+        return __libc_malloc(size);
+       #else
+        return std::malloc(size);
+       #endif
+    }
+
+    void* rawAllocateAligned (size_t size, size_t alignment) noexcept
+    {
+       #if SLOPE_INTERPOSE_LIBC
+        return __libc_memalign(alignment, size);
+       #elif JUCE_WINDOWS
+        return _aligned_malloc(size, alignment);
+       #else
+        void* result = nullptr;
+        return posix_memalign(&result, juce::jmax(alignment, sizeof(void*)), size) == 0 ? result : nullptr;
+       #endif
+    }
+
+    void rawFree (void* pointer) noexcept
+    {
+       #if SLOPE_INTERPOSE_LIBC
+        __libc_free(pointer);
+       #else
+        std::free(pointer);
+       #endif
+    }
+
+    void rawFreeAligned (void* pointer) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(pointer);
+       #else
+        rawFree(pointer);
+       #endif
+    }
+
+    void* allocate (size_t size)
+    {
+        report(Violation::Allocation);
+        if(auto* result = rawAllocate(size == 0 ? 1 : size)) {
+            return result;
+        }
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned (size_t size, std::align_val_t alignment)
+    {
+        report(Violation::Allocation);
+        if(auto* result = rawAllocateAligned(size == 0 ? 1 : size, static_cast<size_t>(alignment))) {
+            return result;
+        }
+        throw std::bad_alloc();
+    }
+
+    void release (void* pointer) noexcept
+    {
+        if(pointer != nullptr) {
+            report(Violation::Deallocation);
+            rawFree(pointer);
+        }
+    }
+
+    void releaseAligned (void* pointer) noexcept
+    {
+        if(pointer != nullptr) {
+            report(Violation::Deallocation);
+            rawFreeAligned(pointer);
+        }
+    }
+
+   #if SLOPE_INTERPOSE_LIBC
+    using MutexLockFunction = int (*) (pthread_mutex_t*);
+
+    // constant initialised, static initialisers elsewhere can lock before this file's would have run.
+    // glibc's own __pthread_mutex_lock is only a compatibility symbol since 2.34, so it can't be linked to
+    std::atomic<MutexLockFunction> realMutexLock { nullptr };
+
+    /** The pthread_mutex_lock this one stands in for, looked up on first use. Scope looks it up too,
+        so dlsym is never called for the first time inside a guard.
+    */
+    MutexLockFunction getRealMutexLock() noexcept
+    {
+        auto function = realMutexLock.load(std::memory_order_acquire);
+
+        if(function == nullptr)
+        {
+            function = reinterpret_cast<MutexLockFunction>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+            realMutexLock.store(function, std::memory_order_release);
+        }
+        return function;
+    }
+
+    /** Only if the lookup failed: waits for the mutex without the real lock function. */
+    int spinMutexLock (pthread_mutex_t* mutex) noexcept
+    {
+        int result;
+        while((result = pthread_mutex_trylock(mutex)) == EBUSY) {
+            sched_yield();
+        }
+        return result;
+    }
+   #endif
+}
+
+//==============================================================================
+AudioThreadGuard::Scope::Scope() noexcept
+{
+   #if SLOPE_INTERPOSE_LIBC
+    getRealMutexLock();
+   #endif
+    guarded = true;
+}
+
+AudioThreadGuard::Scope::~Scope() noexcept
+{
+    guarded = false;
+}
+
+int AudioThreadGuard::getNumViolations() noexcept
+{
+    return numViolations.load();
+}
+
+void AudioThreadGuard::setMaxReports (int maxReportsToPrint) noexcept
+{
+    reportsLeft = maxReportsToPrint;
+}
+
+void AudioThreadGuard::setContext (const char* description) noexcept
+{
+    context = description;
+}
+
+//==============================================================================
+void* operator new (size_t size)                                            { return allocate(size); }
+void* operator new[] (size_t size)                                          { return allocate(size); }
+void* operator new (size_t size, const std::nothrow_t&) noexcept            { report(Violation::Allocation); return rawAllocate(size == 0 ? 1 : size); }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept          { report(Violation::Allocation); return rawAllocate(size == 0 ? 1 : size); }
+void* operator new (size_t size, std::align_val_t alignment)                { return allocateAligned(size, alignment); }
+void* operator new[] (size_t size, std::align_val_t alignment)              { return allocateAligned(size, alignment); }
+
+void operator delete (void* pointer) noexcept                               { release(pointer); }
+void operator delete[] (void* pointer) noexcept                             { release(pointer); }
+void operator delete (void* pointer, size_t) noexcept                       { release(pointer); }
+void operator delete[] (void* pointer, size_t) noexcept                     { release(pointer); }
+void operator delete (void* pointer, const std::nothrow_t&) noexcept        { release(pointer); }
+void operator delete[] (void* pointer, const std::nothrow_t&) noexcept      { release(pointer); }
+void operator delete (void* pointer, std::align_val_t) noexcept             { releaseAligned(pointer); }
+void operator delete[] (void* pointer, std::align_val_t) noexcept           { releaseAligned(pointer); }
+void operator delete (void* pointer, size_t, std::align_val_t) noexcept     { releaseAligned(pointer); }
+void operator delete[] (void* pointer, size_t, std::align_val_t) noexcept   { releaseAligned(pointer); }
+
+#if SLOPE_INTERPOSE_LIBC
+extern "C"
+{
+    void* malloc (size_t size)                  { report(Violation::Allocation); return __libc_malloc(size); }
+    void* calloc (size_t count, size_t size)    { report(Violation::Allocation); return __libc_calloc(count, size); }
+    void* realloc (void* pointer, size_t size)  { report(Violation::Allocation); return __libc_realloc(pointer, size); }
+    void  free (void* pointer)                  { if(pointer != nullptr) { report(Violation::Deallocation); } __libc_free(pointer); }
+
+    int pthread_mutex_lock (pthread_mutex_t* mutex)
+    {
+        report(Violation::Lock);
+
+        if(const auto function = getRealMutexLock()) {
+            return function(mutex);
+        }
+        return spinMutexLock(mutex);
+    }
+}
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+/** Catches allocations and locks on a thread while it is marked as the audio thread.
+
+    operator new and delete are replaced everywhere. On Linux with glibc, malloc, calloc, realloc,
+    free and pthread_mutex_lock are interposed as well, which covers std::mutex, juce::CriticalSection
+    and anything inside JUCE or the C++ runtime that allocates through malloc. Other platforms only
+    see the operator new and delete calls.
+
+    Each violation is counted, and the first few are printed to stderr with the stack that caused them.
+*/
+namespace AudioThreadGuard
+{
+    /** Marks the calling thread as the audio thread for its lifetime. */
+    struct Scope
+    {
+        Scope() noexcept;
+        ~Scope() noexcept;
+
+        Scope (const Scope&) = delete;
+        Scope& operator= (const Scope&) = delete;
+    };
+
+    /** Total number of violations so far. */
+    int getNumViolations() noexcept;
+
+    /** Sets how many more violations get their stack printed (10 by default). */
+    void setMaxReports (int maxReportsToPrint) noexcept;
+
+    /** Text printed above the next stacks, to say what the processor was doing. */
+    void setContext (const char* description) noexcept;
+}
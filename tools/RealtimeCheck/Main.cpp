@@ -0,0 +1,264 @@
+/*
+    Realtime safety check.
+
+    Drives the full plugin (AudioPluginAudioProcessor) through parameter sweeps with AudioThreadGuard
+    active around every processBlock() and processBlockBypassed() call, so anything on the audio path
+    that allocates, frees or takes a mutex is reported with the stack that did it.
+
+    Every configuration (sample rate, block size, channel count, precision, realtime or offline, engine) runs
+    the same sweep: each parameter is stepped through its range once from the "message thread"
+    (setValueNotifyingHost() between blocks, as a host or the editor would), once as sample
+    accurate automation (addParameterEvent(), from inside the guard) and once as CLAP parameter value
+    events (handleDirectEvent(), from inside the guard, with applyHostValues() after each step standing
+    in for the timer). The sweep also covers the low latency switch, switching between realtime and
+    offline and between the engines without preparing again, the wet chain going idle and back,
+    sleeping through silence, bypass, and blocks shorter than the prepared size.
+
+    Usage: RealtimeCheck [--stacks <n>]
+
+    --stacks <n>          print the stacks of the first n violations (default 10)
+
+    One CSV row is printed per configuration. Returns 0 if nothing was caught.
+*/
+
+#include <juce_events/juce_events.h>
+#include <iostream>
+#include <optional>
+#include "PluginProcessor.h"
+#include "AudioThreadGuard.h"
+
+namespace
+{
+    using AutomatedParameter = AudioPluginAudioProcessor::AutomatedParameter;
+
+    struct Configuration
+    {
+        double sampleRate;
+        int blockSize, numChannels;
+        bool doublePrecision, offline, tickSampled;
+    };
+
+    struct Change
+    {
+        const char* id;
+        float value;
+    };
+
+    /** Every parameter through its range and back to its default. */
+    const std::vector<Change> sweep
+    {
+        { "sRate", 0.0f },  { "sRate", 3.0f },  { "sRate", 6.0f },  { "sRate", 9.0f },
+        { "sRate", 12.0f }, { "sRate", 15.0f }, { "sRate", 7.0f },
+        { "inGain", -60.0f }, { "inGain", 24.0f }, { "inGain", 0.0f },
+        { "outGain", -60.0f }, { "outGain", 12.0f }, { "outGain", 0.0f },
+        { "aaFilt", 0.0f }, { "aaFilt", 1.0f },
+        { "speaker", 1.0f }, { "speaker", 2.0f }, { "speaker", 0.0f },
+        { "active", 0.0f }, { "active", 1.0f },
+        { "lowLatency", 1.0f }, { "lowLatency", 0.0f },
+    };
+
+    //==============================================================================
+    template <typename SampleType>
+    class SweepRunner
+    {
+    public:
+        SweepRunner (const Configuration& c) : config(c), buffer(c.numChannels, c.blockSize) {}
+
+        void run()
+        {
+            processor.setPlayConfigDetails(config.numChannels, config.numChannels, config.sampleRate, config.blockSize);
+            processor.setProcessingPrecision(config.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                                    : juce::AudioProcessor::singlePrecision);
+            processor.setNonRealtime(config.offline);
+
+            // the engine a session was saved with, later switches happen while playing (see below)
+            auto* engine = processor.apvts.getParameter("engine");
+            engine->setValueNotifyingHost(engine->convertTo0to1(config.tickSampled ? 1.0f : 0.0f));
+            processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+            step("warming up", Signal::Noise, stepSeconds);
+
+            for(const auto& change : sweep)
+            {
+                auto* parameter = processor.apvts.getParameter(change.id);
+                parameter->setValueNotifyingHost(parameter->convertTo0to1(change.value));
+                step(juce::String("host change ") + change.id + " = " + juce::String(change.value), Signal::Noise, stepSeconds);
+            }
+
+            for(const auto& change : sweep)
+            {
+                if(const auto automated = AudioPluginAudioProcessor::getAutomatedParameter(change.id)) {
+                    pendingEvent = std::make_pair(*automated, change.value);
+                    step(juce::String("automating ") + change.id + " = " + juce::String(change.value), Signal::Noise, stepSeconds);
+                }
+            }
+
+            // every parameter, settings included, as the CLAP wrapper hands them over
+            for(const auto& change : sweep)
+            {
+                pendingClapEvent = change;
+                step(juce::String("CLAP event ") + change.id + " = " + juce::String(change.value), Signal::Noise, stepSeconds);
+            }
+
+            // hosts may start or stop a bounce without preparing again
+            processor.setNonRealtime(!config.offline);
+            step("render mode switched", Signal::Noise, stepSeconds);
+            processor.setNonRealtime(config.offline);
+            step("render mode switched back", Signal::Noise, stepSeconds);
+
+            // the engine swaps on the audio thread, without preparing again
+            engine->setValueNotifyingHost(engine->convertTo0to1(config.tickSampled ? 0.0f : 1.0f));
+            step("engine switched", Signal::Noise, stepSeconds);
+            engine->setValueNotifyingHost(engine->convertTo0to1(config.tickSampled ? 1.0f : 0.0f));
+            step("engine switched back", Signal::Noise, stepSeconds);
+
+            step("input stopping", Signal::Silence, processor.getTailLengthSeconds() + stepSeconds);
+            step("waking from silence", Signal::Noise, stepSeconds);
+            step("bypassed", Signal::Bypassed, stepSeconds);
+            step("leaving bypass", Signal::Noise, stepSeconds);
+
+            processor.releaseResources();
+        }
+
+    private:
+        enum struct Signal
+        {
+            Noise,
+            Silence,
+            Bypassed
+        };
+
+        /** Processes seconds of audio in blocks of random length up to the prepared size. */
+        void step (const juce::String& description, Signal signal, double seconds)
+        {
+            context = description.toStdString();
+            AudioThreadGuard::setContext(context.c_str());
+
+            auto remaining = static_cast<int>(std::ceil(seconds * config.sampleRate));
+
+            while(remaining > 0)
+            {
+                const auto numSamples = juce::jmin(remaining, 1 + random.nextInt(config.blockSize));
+                remaining -= numSamples;
+
+                // the host owns the buffer and fills it before the call
+                juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), config.numChannels, numSamples);
+                for(int c = 0; c < config.numChannels; ++c) {
+                    for(int s = 0; s < numSamples; ++s) {
+                        block.setSample(c, s, signal == Signal::Silence ? SampleType(0) : static_cast<SampleType>(random.nextFloat() - 0.5f));
+                    }
+                }
+
+                const AudioThreadGuard::Scope guard;
+
+                if(pendingEvent.has_value()) {
+                    processor.addParameterEvent(pendingEvent->first, numSamples / 2, pendingEvent->second);
+                    pendingEvent.reset();
+                }
+
+                if(pendingClapEvent.has_value()) {
+                    sendClapEvent(*pendingClapEvent, numSamples / 2);
+                    pendingClapEvent.reset();
+                }
+
+                if(signal == Signal::Bypassed) {
+                    processor.processBlockBypassed(block, midi);
+                }
+                else {
+                    processor.processBlock(block, midi);
+                }
+            }
+
+            // outside the guard, standing in for the timer on the message thread
+            processor.applyHostValues();
+        }
+
+        /** A CLAP parameter value event, addressed the way the wrapper addresses parameters. */
+        void sendClapEvent (const Change& change, int sampleOffset)
+        {
+            auto* parameter = processor.apvts.getParameter(change.id);
+
+            clap_event_param_value_t event {};
+            event.header.size     = sizeof(event);
+            event.header.time     = static_cast<uint32_t>(sampleOffset);
+            event.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+            event.header.type     = CLAP_EVENT_PARAM_VALUE;
+            event.param_id        = static_cast<clap_id>(parameter->getParameterID().hashCode());
+            event.note_id         = -1;
+            event.port_index      = -1;
+            event.channel         = -1;
+            event.key             = -1;
+            event.value           = parameter->convertTo0to1(change.value);
+
+            processor.handleDirectEvent(&event.header, sampleOffset);
+        }
+
+        static constexpr double stepSeconds = 0.05;
+
+        Configuration config;
+        AudioPluginAudioProcessor processor;
+        juce::AudioBuffer<SampleType> buffer;
+        juce::MidiBuffer midi;
+        juce::Random random { 1 };
+        std::optional<std::pair<AutomatedParameter, float>> pendingEvent;
+        std::optional<Change> pendingClapEvent;
+        std::string context;
+    };
+
+    void printRow (const juce::StringArray& row)
+    {
+        std::cout << row.joinIntoString(",") << std::endl;
+    }
+
+    int printUsage()
+    {
+        std::cerr << "Usage: RealtimeCheck [--stacks <n>]" << std::endl;
+        return 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if(arg == "--stacks" && i + 1 < argc) {
+            AudioThreadGuard::setMaxReports(juce::String(argv[++i]).getIntValue());
+        }
+        else {
+            return printUsage();
+        }
+    }
+
+    printRow({ "sample_rate", "block_size", "channels", "precision", "mode", "engine", "violations" });
+
+    for(auto sampleRate : { 44100.0, 48000.0, 96000.0, 192000.0 })
+    for(auto blockSize : { 32, 512, 1023 })
+    for(auto numChannels : { 1, 2 })
+    for(auto doublePrecision : { false, true })
+    for(auto offline : { false, true })
+    for(auto tickSampled : { false, true })
+    {
+        const Configuration config { sampleRate, blockSize, numChannels, doublePrecision, offline, tickSampled };
+        const auto before = AudioThreadGuard::getNumViolations();
+
+        if(doublePrecision) {
+            SweepRunner<double>(config).run();
+        }
+        else {
+            SweepRunner<float>(config).run();
+        }
+
+        printRow({ juce::String(sampleRate, 0), juce::String(blockSize), juce::String(numChannels),
+                   doublePrecision ? "double" : "float", offline ? "offline" : "realtime", tickSampled ? "tick" : "oversampled",
+                   juce::String(AudioThreadGuard::getNumViolations() - before) });
+    }
+
+    const auto numViolations = AudioThreadGuard::getNumViolations();
+    std::cout << (numViolations == 0 ? juce::String("No realtime violations") : juce::String(numViolations) + " realtime violations") << std::endl;
+    return numViolations == 0 ? 0 : 1;
+}